@@ -57,6 +57,12 @@ struct RewardPolicy {
                      current_reward_policy(1), policy_switch_counter(0), neighbor_overlap(NO_OVERLAP) {}
 };
 
+enum RestartPolicy {
+    NO_RESTARTS,
+    LUBY_RESTARTS,
+    GEOMETRIC_RESTARTS
+};
+
 enum MCS {
     RL_DAL, LL_DAL
 };
@@ -72,6 +78,7 @@ EXTERN struct arguments {
     bool edge_labelled;
     bool vertex_labelled;
     bool big_first;
+    bool pattern;
     bool random_start;
     Heuristic heuristic;
     SortHeuristic::Base *sort_heuristic;
@@ -81,7 +88,25 @@ EXTERN struct arguments {
     char *filename2;
     int timeout;
     int max_iter;
+    double decision;
+    double warm_start;
+    bool twins;
+    bool complement;
+    int parallel_goals;
+    RestartPolicy restart_policy;
+    unsigned long long restart_base;
+    int max_restarts;
+    char *checkpoint;
+    int checkpoint_interval;
+    char *resume;
+    char *incumbents;
+    char *score_cache;
     int arg_num;
+    bool batch;
+    bool all_pairs;
+    int threads;
+    bool pin_threads;
+    char *output;
     SwapPolicy swap_policy;
     RewardPolicy reward_policy;
 } arguments;
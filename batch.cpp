@@ -0,0 +1,214 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include "args.h"
+#include "solver.h"
+#include "thread_pool.h"
+#include "./nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+static void fail(std::string msg) {
+    std::cerr << msg << std::endl;
+    exit(1);
+}
+
+std::vector<std::string> read_manifest(const std::string &manifest) {
+    std::ifstream file(manifest);
+    if (!file)
+        fail("Cannot open manifest " + manifest);
+    std::vector<std::string> paths;
+    std::string line;
+    while (std::getline(file, line)) {
+        // strip trailing whitespace (and Windows line endings)
+        while (!line.empty() && isspace((unsigned char) line.back()))
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+        paths.push_back(line);
+    }
+    return paths;
+}
+
+/**
+ * Run `worker` on `threads` lanes of the shared thread pool (the calling thread included) and wait for all of them.
+ */
+static void run_workers(int threads, const std::function<void()> &worker) {
+    thread_pool().run_lanes(threads, [&](int) { worker(); });
+}
+
+static std::ostream &open_output(const std::string &output_path, std::ofstream &output_file) {
+    if (output_path == "-")
+        return std::cout;
+    output_file.open(output_path);
+    if (!output_file)
+        fail("Cannot open output file " + output_path);
+    return output_file;
+}
+
+static Graph read_graph_path(const std::string &path) {
+    std::vector<char> filename(path.begin(), path.end());
+    filename.push_back('\0');
+    return read_input_graph(filename.data());
+}
+
+static json mapping_to_json(const std::vector<VtxPair> &solution) {
+    json mapping = json::array();
+    for (auto &p: solution)
+        mapping.push_back({p.v, p.w});
+    return mapping;
+}
+
+void run_one_vs_many(char *query_filename, const std::string &manifest, const std::string &output_path) {
+    std::vector<std::string> targets = read_manifest(manifest);
+
+    std::ofstream output_file;
+    std::ostream &out = open_output(output_path, output_file);
+
+    auto start = std::chrono::steady_clock::now();
+    PreparedGraph query = prepare_graph(read_input_graph(query_filename), arguments.sort_heuristic);
+    query.name = query_filename;
+    auto prepared = std::chrono::steady_clock::now();
+    std::cerr << "Query preprocessed in " << std::chrono::duration<double, std::milli>(prepared - start).count()
+              << "ms, " << targets.size() << " targets" << std::endl;
+
+    std::atomic<size_t> next(0);
+    std::mutex output_mutex;
+    auto worker = [&] {
+        while (true) {
+            size_t i = next++;
+            if (i >= targets.size())
+                break;
+            PreparedGraph target = prepare_graph(read_graph_path(targets[i]), arguments.sort_heuristic);
+            PairResult result = solve_pair(query, target, arguments.timeout);
+
+            bool valid = check_sol(query.graph, target.graph, result.solution);
+            json record = {{"index",   i},
+                           {"query",   query.name},
+                           {"target",  targets[i]},
+                           {"size",    result.solution.size()},
+                           {"nodes",   result.nodes},
+                           {"bound",   result.bound},
+                           {"settled", result.settled},
+                           {"time_ms", result.time_ms},
+                           {"timeout", result.timed_out},
+                           {"valid",   valid},
+                           {"mapping", mapping_to_json(result.solution)}};
+            if (arguments.decision > 0) {
+                record["threshold"] = result.decision_goal;
+                record["decision"] = decision_answer(result.solution.size(), result.decision_goal, result.timed_out);
+            }
+            std::lock_guard<std::mutex> guard(output_mutex);
+            out << record.dump() << std::endl;
+        }
+    };
+
+    run_workers(arguments.threads, worker);
+
+    auto stop = std::chrono::steady_clock::now();
+    std::cerr << "Batch done in " << std::chrono::duration<double, std::milli>(stop - start).count() << "ms"
+              << std::endl;
+}
+
+void run_all_pairs(const std::string &manifest, const std::string &output_path) {
+    std::vector<std::string> paths = read_manifest(manifest);
+    const size_t k = paths.size();
+    if (k == 0)
+        fail("Empty manifest " + manifest);
+
+    std::ofstream output_file;
+    std::ostream &out = open_output(output_path, output_file);
+
+    // load and preprocess the whole collection once
+    auto start = std::chrono::steady_clock::now();
+    std::vector<PreparedGraph> graphs(k);
+    std::atomic<size_t> next(0);
+    run_workers(arguments.threads, [&] {
+        for (size_t i = next++; i < k; i = next++) {
+            graphs[i] = prepare_graph(read_graph_path(paths[i]), arguments.sort_heuristic);
+            graphs[i].name = paths[i];
+        }
+    });
+    auto prepared = std::chrono::steady_clock::now();
+    std::cerr << "Collection of " << k << " graphs preprocessed in "
+              << std::chrono::duration<double, std::milli>(prepared - start).count() << "ms" << std::endl;
+
+    // each unordered pair is solved once; the diagonal is trivial
+    std::vector<std::pair<int, int>> pairs;
+    pairs.reserve(k * (k - 1) / 2);
+    for (size_t i = 0; i < k; i++)
+        for (size_t j = i + 1; j < k; j++)
+            pairs.emplace_back(i, j);
+
+    // Longest-processing-time first: the search space grows with |g0| * |g1|, so the largest pairs are
+    // started first and the small ones fill the gaps at the end, when some workers are already idle
+    auto cost = [&](const std::pair<int, int> &p) {
+        return (double) graphs[p.first].graph.n * graphs[p.second].graph.n;
+    };
+    std::stable_sort(pairs.begin(), pairs.end(),
+                     [&](const std::pair<int, int> &a, const std::pair<int, int> &b) { return cost(a) > cost(b); });
+
+    // in decision mode the cells hold 1 (yes) or 0 (no or unknown) instead of the solution size
+    std::vector<std::vector<int>> sizes(k, std::vector<int>(k, 0));
+    std::vector<std::vector<bool>> timed_out(k, std::vector<bool>(k, false));
+    for (size_t i = 0; i < k; i++)
+        sizes[i][i] = arguments.decision > 0 ? graphs[i].graph.n >= (int) decision_goal(graphs[i].graph.n, graphs[i].graph.n)
+                                             : graphs[i].graph.n;
+
+    std::atomic<size_t> next_pair(0);
+    std::atomic<size_t> done(0);
+    std::mutex progress_mutex;
+    run_workers(arguments.threads, [&] {
+        for (size_t p = next_pair++; p < pairs.size(); p = next_pair++) {
+            int i = pairs[p].first, j = pairs[p].second;
+            PairResult result = solve_pair(graphs[i], graphs[j], arguments.timeout);
+            if (!check_sol(graphs[i].graph, graphs[j].graph, result.solution))
+                std::cerr << "*** Error: Invalid solution for " << paths[i] << " " << paths[j] << std::endl;
+            // each cell is written by exactly one worker
+            if (arguments.decision > 0)
+                sizes[i][j] = sizes[j][i] = result.solution.size() >= result.decision_goal;
+            else
+                sizes[i][j] = sizes[j][i] = (int) result.solution.size();
+            if (result.timed_out) {
+                std::lock_guard<std::mutex> guard(progress_mutex); // vector<bool> packs cells into shared words
+                timed_out[i][j] = timed_out[j][i] = true;
+            }
+            size_t count = ++done;
+            if (!arguments.verbose)
+                continue;
+            std::lock_guard<std::mutex> guard(progress_mutex);
+            std::cerr << count << "/" << pairs.size() << " " << paths[i] << " " << paths[j] << ": "
+                      << result.solution.size() << (result.timed_out ? " (timeout)" : "") << std::endl;
+        }
+    });
+
+    // Matrix file: k, the k graph names, k rows of k solution sizes (or decisions), then the pairs that timed out
+    // (their size is only a lower bound, and a 0 decision means unknown)
+    if (arguments.decision > 0)
+        out << "# mcsplit-dal all-pairs decision " << arguments.decision << std::endl;
+    else
+        out << "# mcsplit-dal all-pairs" << std::endl;
+    out << k << std::endl;
+    for (auto &path: paths)
+        out << path << std::endl;
+    for (size_t i = 0; i < k; i++) {
+        for (size_t j = 0; j < k; j++)
+            out << (j ? " " : "") << sizes[i][j];
+        out << std::endl;
+    }
+    out << "# timeouts" << std::endl;
+    for (size_t i = 0; i < k; i++)
+        for (size_t j = i + 1; j < k; j++)
+            if (timed_out[i][j])
+                out << i << " " << j << std::endl;
+
+    auto stop = std::chrono::steady_clock::now();
+    std::cerr << pairs.size() << " pairs solved in " << std::chrono::duration<double, std::milli>(stop - prepared).count()
+              << "ms" << std::endl;
+}
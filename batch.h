@@ -0,0 +1,26 @@
+#ifndef MCSPLITDAL_BATCH_H
+#define MCSPLITDAL_BATCH_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Read a manifest: one graph path per line, empty lines and lines starting with '#' are skipped.
+ */
+std::vector<std::string> read_manifest(const std::string &manifest);
+
+/**
+ * One-vs-many screening: g0 is read and preprocessed once, then every target listed in the manifest
+ * is solved against it by a pool of workers. One JSON record per target is written to output_path
+ * ("-" for stdout) as soon as the target is solved.
+ */
+void run_one_vs_many(char *query_filename, const std::string &manifest, const std::string &output_path);
+
+/**
+ * Many-vs-many similarity matrix: every graph of the manifest is read and preprocessed once and kept in memory,
+ * then each unordered pair is solved once, hardest pairs first (longest-processing-time order), with the
+ * per-pair timeout. The matrix of solution sizes is written to output_path ("-" for stdout).
+ */
+void run_all_pairs(const std::string &manifest, const std::string &output_path);
+
+#endif //MCSPLITDAL_BATCH_H
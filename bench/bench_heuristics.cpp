@@ -0,0 +1,362 @@
+/**
+ * Cost and benefit of the sort heuristics.
+ *
+ * Cost: every heuristic sorts preferential attachment graphs of increasing size, for each thread count. Each run
+ * is a forked child, so that its peak resident memory (getrusage of the child) only covers one graph and one
+ * heuristic. Reported: wall time of sort(), speedup over the first thread count, peak memory and the part of it
+ * allocated after the graph was built.
+ *
+ * Benefit: with -p, mcsplit-dal runs on every pair of the corpus (one directory per pair holding g1.txt and
+ * g2.txt, as for the run_ascii_*.sh scripts) with every heuristic under the same time budget. Reported: solution
+ * size, DAL nodes, time to the first and to the best incumbent (from the incumbent stream, so including the
+ * heuristic itself) and the total wall time.
+ */
+#include <argp.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../graph.h"
+#include "../heuristics/SortHeuristic.h"
+#include "../nlohmann/json.hpp"
+#include "../thread_pool.h"
+
+using json = nlohmann::json;
+
+// the names accepted by mcsplit-dal -s
+static const std::map<std::string, std::function<SortHeuristic::Base *()>> heuristics = {
+        {"degree",      [] { return new SortHeuristic::Degree(); }},
+        {"pagerank",    [] { return new SortHeuristic::PageRank(); }},
+        {"katz",        [] { return new SortHeuristic::KatzCentrality(); }},
+        {"clustering",  [] { return new SortHeuristic::LocalClusteringCoefficient(); }},
+        {"betweenness", [] { return new SortHeuristic::BetweennessCentrality(); }},
+        {"closeness",   [] { return new SortHeuristic::ClosenessCentrality(); }},
+        {"kcore",       [] { return new SortHeuristic::CoreNumber(); }},
+        {"twohop",      [] { return new SortHeuristic::TwoHopDegree(); }},
+        {"coredegree",  [] { return new SortHeuristic::CoreThenDegree(); }},
+};
+
+static struct {
+    std::vector<std::string> heuristics;
+    std::vector<int> threads;
+    int min_n = 1000;
+    int max_n = 64000;
+    int edges_per_vertex = 4;
+    int limit = 60; // seconds per heuristic run
+    const char *pairs = nullptr;
+    const char *solver = "./build/mcsplit-dal";
+    int budget = 10; // seconds per search
+} options;
+
+static std::vector<std::string> split(const std::string &list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    for (std::string item; std::getline(stream, item, ',');)
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+static void fail(const std::string &msg) {
+    std::cerr << msg << std::endl;
+    exit(1);
+}
+
+static char doc[] = "Measure the cost (time, memory, thread scaling) and the search benefit of the sort heuristics";
+static struct argp_option argp_options[] = {
+        {"heuristics", 's', "list",    0, "Comma separated heuristics (default: all)"},
+        {"threads",    'T', "list",    0, "Comma separated thread counts (default: 1, 2, 4, ... up to the CPUs)"},
+        {"min-n",      'm', "n",       0, "Smallest graph (default 1000 vertices)"},
+        {"max-n",      'n', "n",       0, "Largest graph (default 64000 vertices); the size grows 4 times per step"},
+        {"edges",      'e', "k",       0, "Edges added with each vertex of the generated graphs (default 4)"},
+        {"limit",      'l', "seconds", 0, "Time limit of one heuristic run (default 60)"},
+        {"pairs",      'p', "dir",     0, "Corpus for the search benchmark: one directory per pair with g1.txt, g2.txt"},
+        {"solver",     'b', "binary",  0, "mcsplit-dal binary for the search benchmark (default ./build/mcsplit-dal)"},
+        {"budget",     't', "seconds", 0, "Time budget of one search (default 10)"},
+        {0}
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state) {
+    switch (key) {
+        case 's':
+            options.heuristics = split(arg);
+            for (auto &name: options.heuristics)
+                if (!heuristics.count(name))
+                    fail("Unknown heuristic " + name);
+            break;
+        case 'T':
+            options.threads.clear();
+            for (auto &item: split(arg))
+                options.threads.push_back(std::max(1, std::stoi(item)));
+            break;
+        case 'm':
+            options.min_n = std::stoi(arg);
+            break;
+        case 'n':
+            options.max_n = std::stoi(arg);
+            break;
+        case 'e':
+            options.edges_per_vertex = std::stoi(arg);
+            break;
+        case 'l':
+            options.limit = std::stoi(arg);
+            break;
+        case 'p':
+            options.pairs = arg;
+            break;
+        case 'b':
+            options.solver = arg;
+            break;
+        case 't':
+            options.budget = std::stoi(arg);
+            break;
+        case ARGP_KEY_ARG:
+            argp_usage(state);
+        default:
+            return ARGP_ERR_UNKNOWN;
+    }
+    return 0;
+}
+
+static struct argp argp = {argp_options, parse_opt, 0, doc};
+
+/**
+ * Preferential attachment: each new vertex joins k distinct earlier vertices, picked with probability
+ * proportional to their degree. Fixed seed, so every run sees the same graph.
+ */
+static Graph preferential_attachment(int n, int k) {
+    Graph g(n);
+    std::mt19937 rng(n);
+    std::vector<int> endpoints; // every vertex once per incident edge
+    std::vector<int> targets;
+    for (int v = 0; v < n; v++) {
+        targets.clear();
+        for (int attempt = 0; attempt < 4 * k && (int) targets.size() < std::min(k, v); attempt++) {
+            int u = endpoints.empty() ? (int) (rng() % v)
+                                      : endpoints[rng() % endpoints.size()];
+            if (std::find(targets.begin(), targets.end(), u) == targets.end())
+                targets.push_back(u);
+        }
+        for (int u: targets) {
+            g.adjlist[v].adjNodes.push_back(Node(u, 0));
+            g.adjlist[u].adjNodes.push_back(Node(v, 0));
+            endpoints.push_back(u);
+            endpoints.push_back(v);
+        }
+    }
+    g.e = (int) endpoints.size() / 2;
+    return g;
+}
+
+// sent by the child through a pipe
+struct CostReport {
+    int m = 0;
+    double ms = 0;
+    long graph_kb = 0; // peak memory before the heuristic started
+};
+
+struct CostResult {
+    bool ok = false;
+    bool timed_out = false;
+    CostReport report;
+    long peak_kb = 0; // of the whole child
+};
+
+// sort one generated graph in a child process
+static CostResult measure_cost(const std::string &name, int n, int threads) {
+    int channel[2];
+    if (pipe(channel) != 0)
+        fail("pipe failed");
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0)
+        fail("fork failed");
+    if (pid == 0) {
+        close(channel[0]);
+        Graph g = preferential_attachment(n, options.edges_per_vertex);
+        init_thread_pool(threads, false);
+        SortHeuristic::Base *heuristic = heuristics.at(name)();
+        heuristic->set_num_threads(threads);
+        CostReport report;
+        report.m = g.e;
+        struct rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        report.graph_kb = usage.ru_maxrss;
+        alarm(options.limit);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<int> scores = heuristic->sort(g);
+        report.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        bool sent = write(channel[1], &report, sizeof(report)) == sizeof(report);
+        _exit(sent && (int) scores.size() == n ? 0 : 1);
+    }
+    close(channel[1]);
+    CostResult result;
+    bool received = read(channel[0], &result.report, sizeof(result.report)) == sizeof(result.report);
+    close(channel[0]);
+    int status = 0;
+    struct rusage usage{};
+    wait4(pid, &status, 0, &usage);
+    result.peak_kb = usage.ru_maxrss;
+    result.timed_out = WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM;
+    result.ok = received && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    return result;
+}
+
+static void cost_benchmark() {
+    std::printf("# cost: preferential attachment graphs, %d edges per new vertex, limit %d s per run\n",
+                options.edges_per_vertex, options.limit);
+    std::printf("%-12s %8s %9s %7s %12s %8s %10s %10s\n",
+                "heuristic", "n", "m", "threads", "time_ms", "speedup", "peak_kb", "extra_kb");
+    for (auto &name: options.heuristics) {
+        for (int n = options.min_n; n <= options.max_n; n *= 4) {
+            double base_ms = 0; // with the first thread count
+            bool too_slow = false;
+            for (int threads: options.threads) {
+                CostResult r = measure_cost(name, n, threads);
+                if (!r.ok) {
+                    std::printf("%-12s %8d %9s %7d %12s\n", name.c_str(), n, "-", threads,
+                                r.timed_out ? "timeout" : "failed");
+                    too_slow = too_slow || r.timed_out;
+                    continue;
+                }
+                if (base_ms == 0)
+                    base_ms = r.report.ms;
+                std::printf("%-12s %8d %9d %7d %12.2f %8.2f %10ld %10ld\n", name.c_str(), n, r.report.m, threads,
+                            r.report.ms, base_ms / std::max(r.report.ms, 1e-6), r.peak_kb,
+                            r.peak_kb - r.report.graph_kb);
+                std::fflush(stdout);
+            }
+            // larger graphs would only time out as well
+            if (too_slow)
+                break;
+        }
+    }
+}
+
+struct SearchResult {
+    bool ok = false;
+    int size = -1;
+    unsigned long long nodes = 0;
+    double first_ms = -1, best_ms = -1; // -1: no incumbent
+    double wall_ms = 0;
+    bool timed_out = false;
+};
+
+static SearchResult run_search(const std::string &name, const std::string &g1, const std::string &g2) {
+    char out_path[] = "/tmp/bench_heuristics_outXXXXXX";
+    char incumbents_path[] = "/tmp/bench_heuristics_incXXXXXX";
+    int out_fd = mkstemp(out_path);
+    int incumbents_fd = mkstemp(incumbents_path);
+    if (out_fd < 0 || incumbents_fd < 0)
+        fail("Cannot create temporary files");
+    close(incumbents_fd);
+    std::string budget = std::to_string(options.budget);
+    std::vector<std::string> args = {options.solver, "-A", "-t", budget, "-s", name, "-j", incumbents_path,
+                                     "min_max", g1, g2};
+
+    SearchResult result;
+    auto start = std::chrono::steady_clock::now();
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0)
+        fail("fork failed");
+    if (pid == 0) {
+        dup2(out_fd, STDOUT_FILENO);
+        dup2(out_fd, STDERR_FILENO);
+        std::vector<char *> argv;
+        for (auto &arg: args)
+            argv.push_back((char *) arg.c_str());
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    close(out_fd);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    result.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+    std::ifstream out(out_path);
+    for (std::string line; std::getline(out, line);) {
+        if (line.rfind("Solution size ", 0) == 0)
+            result.size = std::stoi(line.substr(14));
+        else if (line.rfind("Nodes:", 0) == 0)
+            result.nodes = std::stoull(line.substr(6));
+        else if (line == "TIMEOUT")
+            result.timed_out = true;
+    }
+    std::ifstream incumbents(incumbents_path);
+    for (std::string line; std::getline(incumbents, line);) {
+        json record = json::parse(line, nullptr, false);
+        if (record.is_discarded())
+            continue;
+        if (result.first_ms < 0)
+            result.first_ms = record["time_ms"];
+        result.best_ms = record["time_ms"];
+    }
+    unlink(out_path);
+    unlink(incumbents_path);
+    result.ok = result.ok && result.size >= 0;
+    return result;
+}
+
+static void search_benchmark() {
+    std::vector<std::string> pairs;
+    if (DIR *dir = opendir(options.pairs)) {
+        while (struct dirent *entry = readdir(dir)) {
+            std::string path = std::string(options.pairs) + "/" + entry->d_name;
+            if (entry->d_name[0] != '.' && access((path + "/g1.txt").c_str(), R_OK) == 0 &&
+                access((path + "/g2.txt").c_str(), R_OK) == 0)
+                pairs.push_back(path);
+        }
+        closedir(dir);
+    }
+    if (pairs.empty())
+        fail(std::string("No pair (directory with g1.txt and g2.txt) in ") + options.pairs);
+    std::sort(pairs.begin(), pairs.end());
+
+    std::printf("\n# search: %s, budget %d s per pair\n", options.solver, options.budget);
+    std::printf("%-24s %-12s %6s %14s %12s %12s %12s %8s\n",
+                "pair", "heuristic", "size", "nodes", "first_ms", "best_ms", "wall_ms", "status");
+    for (auto &pair: pairs) {
+        std::string pair_name = pair.substr(pair.find_last_of('/') + 1);
+        for (auto &name: options.heuristics) {
+            SearchResult r = run_search(name, pair + "/g1.txt", pair + "/g2.txt");
+            std::printf("%-24s %-12s %6d %14llu %12.1f %12.1f %12.1f %8s\n", pair_name.c_str(), name.c_str(), r.size,
+                        r.nodes, r.first_ms, r.best_ms, r.wall_ms,
+                        !r.ok ? "failed" : r.timed_out ? "timeout" : "solved");
+            std::fflush(stdout);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    for (auto &entry: heuristics)
+        options.heuristics.push_back(entry.first);
+    for (int threads = 1; threads <= (int) std::max(1u, std::thread::hardware_concurrency()); threads *= 2)
+        options.threads.push_back(threads);
+    argp_parse(&argp, argc, argv, 0, 0, 0);
+    if (options.min_n < 1 || options.max_n < options.min_n)
+        fail("Invalid graph sizes");
+
+    cost_benchmark();
+    if (options.pairs)
+        search_benchmark();
+    return 0;
+}
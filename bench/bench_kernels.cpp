@@ -0,0 +1,250 @@
+/**
+ * Microbenchmarks of the search kernels on a synthetic state: two random graphs of n vertices and k bidomains
+ * of equal size splitting them, as after a few levels of the search. Each kernel runs until it has taken at
+ * least the minimum time; reported are the nanoseconds and the heap allocations (counted by the replaced
+ * operator new) per operation. Kernels that change the state undo their changes inside the timed operation.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+
+#include "../mcsplit+DAL.h"
+
+static unsigned long long allocations = 0; // the benchmark is single-threaded
+
+void *operator new(std::size_t size) {
+    allocations++;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+static struct {
+    int n = 200;
+    double density = 0.3;
+    int bidomains = 8;
+    int min_ms = 200;
+    const char *filter = nullptr;
+} options;
+
+static char doc[] = "Measure ns/op and allocations/op of the McSplit search kernels on a synthetic search state";
+static struct argp_option argp_options[] = {
+        {"vertices",  'n', "n",       0, "Vertices of each graph (default 200)"},
+        {"density",   'd', "p",       0, "Edge probability of the random graphs (default 0.3)"},
+        {"bidomains", 'k', "k",       0, "Bidomains of the synthetic state (default 8)"},
+        {"min-time",  'm', "ms",      0, "Minimum time spent in each kernel (default 200)"},
+        {"filter",    'f', "name",    0, "Only run the kernels whose name contains this string"},
+        {0}
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state) {
+    switch (key) {
+        case 'n':
+            options.n = std::stoi(arg);
+            break;
+        case 'd':
+            options.density = std::stod(arg);
+            break;
+        case 'k':
+            options.bidomains = std::stoi(arg);
+            break;
+        case 'm':
+            options.min_ms = std::stoi(arg);
+            break;
+        case 'f':
+            options.filter = arg;
+            break;
+        case ARGP_KEY_ARG:
+            argp_usage(state);
+        default:
+            return ARGP_ERR_UNKNOWN;
+    }
+    return 0;
+}
+
+static struct argp argp = {argp_options, parse_opt, 0, doc};
+
+static void fail(const std::string &msg) {
+    std::cerr << msg << std::endl;
+    exit(1);
+}
+
+// sum of the kernels' results, printed at the end so that the compiler keeps the calls
+static long long sink = 0;
+
+/**
+ * Time op() in batches, doubling the batch until one takes at least the minimum time, and report the last batch
+ */
+template<typename Op>
+static void bench(const char *name, Op op) {
+    if (options.filter && !strstr(name, options.filter))
+        return;
+    op(); // warm up
+    for (unsigned long long batch = 1;; batch *= 2) {
+        unsigned long long allocations_before = allocations;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long long i = 0; i < batch; i++)
+            op();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (ns >= options.min_ms * 1e6 || batch >= (1ULL << 40)) {
+            std::printf("%-24s %14.1f %12.2f %14llu\n", name, ns / batch,
+                        (double) (allocations - allocations_before) / batch, batch);
+            std::fflush(stdout);
+            return;
+        }
+    }
+}
+
+static Graph random_graph(int n, double density, unsigned int seed) {
+    Graph g(n);
+    std::mt19937 rng(seed);
+    std::bernoulli_distribution edge(density);
+    int e = 0;
+    for (int u = 0; u < n; u++)
+        for (int v = u + 1; v < n; v++)
+            if (edge(rng)) {
+                g.adjlist[u].adjNodes.push_back(Node(v, 1));
+                g.adjlist[v].adjNodes.push_back(Node(u, 1));
+                e++;
+            }
+    g.e = e;
+    g.pack_leaves();
+    return g;
+}
+
+// the defaults of mcsplit-dal that the kernels read
+static void set_kernel_arguments() {
+    arguments.connected = false;
+    arguments.heuristic = min_max;
+    arguments.mcs_method = RL_DAL;
+    arguments.reward_policy.current_reward_policy = 1;
+    arguments.reward_policy.reward_policies_num = 2;
+    arguments.reward_policy.switch_policy = CHANGE;
+    arguments.reward_policy.dal_reward_policy = DAL_REWARD_MAX_NUM_DOMAINS;
+    arguments.reward_policy.neighbor_overlap = NO_OVERLAP;
+}
+
+int main(int argc, char **argv) {
+    argp_parse(&argp, argc, argv, 0, 0, 0);
+    if (options.n < 2 || options.bidomains < 1 || options.bidomains > options.n)
+        fail("Need at least 2 vertices and between 1 and n bidomains");
+    set_kernel_arguments();
+
+    const int n = options.n, k = options.bidomains;
+    Graph g0 = random_graph(n, options.density, 1);
+    Graph g1 = random_graph(n, options.density, 2);
+    std::mt19937 rng(3);
+
+    // k bidomains of n / k vertices per side (the last one takes the rest), every other one adjacent
+    vector<int> left(n), right(n);
+    std::iota(left.begin(), left.end(), 0);
+    std::iota(right.begin(), right.end(), 0);
+    std::shuffle(left.begin(), left.end(), rng);
+    std::shuffle(right.begin(), right.end(), rng);
+    vector<Bidomain> domains;
+    for (int i = 0, size = n / k; i < k; i++) {
+        int len = i + 1 < k ? size : n - i * size;
+        domains.emplace_back(i * size, i * size, len, len, i % 2 == 0);
+    }
+
+    DoubleQRewards rewards(n, n);
+    // random rewards, so that the selection kernels do not all see ties
+    for (int i = 0; i < n; i++) {
+        rewards.V[i].update(rng() % 100, rng() % 10);
+        rewards.SingleQ[i].update(rng() % 100, rng() % 10);
+        for (Reward &reward: rewards.Q[i])
+            reward.update(rng() % 100, rng() % 10);
+    }
+    Stats stats;
+    stats.abort_due_to_timeout = false;
+    vector<VtxPair> current;
+    vector<int> g0_matched(n, 0), g1_matched(n, 0);
+    vector<int> wselected(n, 0);
+
+    std::printf("# n=%d density=%.2f bidomains=%d (%d x %d vertices)\n", n, options.density, k, n / k, n / k);
+    std::printf("%-24s %14s %12s %14s\n", "kernel", "ns/op", "allocs/op", "ops");
+
+    vector<std::pair<int, int>> pairs(1024);
+    for (auto &pair: pairs)
+        pair = {(int) (rng() % n), (int) (rng() % n)};
+    size_t next_pair = 0;
+    bench("Graph::get", [&] {
+        auto &pair = pairs[next_pair++ % pairs.size()];
+        sink += g0.get(pair.first, pair.second);
+    });
+
+    int next_vertex = 0;
+    bench("partition", [&] {
+        sink += partition(right, 0, n, g1, next_vertex++ % n);
+    });
+
+    bench("calc_bound", [&] {
+        sink += calc_bound(domains);
+    });
+
+    bench("select_bidomain", [&] {
+        sink += select_bidomain(domains, left, rewards, (int) current.size());
+    });
+
+    const Bidomain &bd = domains[0];
+    bench("selectV_index", [&] {
+        sink += selectV_index(left, rewards, bd.l, bd.left_len);
+    });
+
+    int v = left[bd.l + selectV_index(left, rewards, bd.l, bd.left_len)];
+    bench("selectW_index", [&] {
+        sink += selectW_index(g0, g1, current, right, rewards, v, bd.r, bd.right_len, wselected);
+    });
+
+    int w = right[bd.r + selectW_index(g0, g1, current, right, rewards, v, bd.r, bd.right_len, wselected)];
+    // matching v and w also matches some of their leaves: unmatch everything afterwards
+    auto undo = [&] {
+        for (const VtxPair &pair: current) {
+            g0_matched[pair.v] = 0;
+            g1_matched[pair.w] = 0;
+        }
+        current.clear();
+    };
+    bench("generate_new_domains", [&] {
+        NewBidomainResult result = generate_new_domains(domains, 0, current, g0_matched, g1_matched, left, right,
+                                                        g0, g1, v, w, false, &stats);
+        sink += result.new_domains.size();
+        undo();
+    });
+
+    NewBidomainResult result = generate_new_domains(domains, 0, current, g0_matched, g1_matched, left, right,
+                                                    g0, g1, v, w, false, &stats);
+    undo();
+    bench("update_rewards", [&] {
+        rewards.update_rewards(result, v, w, &stats);
+    });
+
+    bench("get_pair_reward", [&] {
+        sink += (long long) rewards.get_pair_reward(v, next_vertex++ % n, false);
+    });
+    std::printf("# checksum %lld\n", sink);
+    return 0;
+}
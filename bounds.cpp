@@ -0,0 +1,152 @@
+#include "bounds.h"
+
+#include <algorithm>
+
+label_count count_labels(const Graph &g) {
+    label_count counts;
+    for (int i = 0; i < g.n; i++)
+        counts[g.adjlist[i].label]++;
+    return counts;
+}
+
+int histogram_intersection(const label_count &c0, const label_count &c1) {
+    int bound = 0;
+    for (auto &entry: c0) {
+        auto it = c1.find(entry.first);
+        if (it != c1.end())
+            bound += std::min(entry.second, it->second);
+    }
+    return bound;
+}
+
+/**
+ * For every label, the largest number of vertices with that label inside a single connected component
+ * of at least two vertices. Isolated vertices can only be part of a connected solution of size 1.
+ */
+static label_count max_component_labels(const Graph &g, int &max_component_size) {
+    label_count max_counts;
+    label_count counts;
+    vector<int> component(g.n, -1);
+    vector<int> queue;
+    queue.reserve(g.n);
+    max_component_size = 0;
+    for (int s = 0; s < g.n; s++) {
+        if (component[s] != -1 || g.adjlist[s].adjNodes.empty())
+            continue;
+        queue.clear();
+        queue.push_back(s);
+        component[s] = s;
+        for (size_t head = 0; head < queue.size(); head++)
+            for (auto &node: g.adjlist[queue[head]].adjNodes)
+                if (component[node.id] == -1) {
+                    component[node.id] = s;
+                    queue.push_back(node.id);
+                }
+        counts.clear();
+        for (int v: queue)
+            counts[g.adjlist[v].label]++;
+        for (auto &entry: counts) {
+            int &best = max_counts[entry.first];
+            best = std::max(best, entry.second);
+        }
+        max_component_size = std::max(max_component_size, (int) queue.size());
+    }
+    return max_counts;
+}
+
+static vector<VtxPair> single_vertex_solution(const Graph &g0, const Graph &g1) {
+    std::unordered_map<unsigned int, int> vertex1;
+    for (int w = 0; w < g1.n; w++)
+        vertex1.emplace(g1.adjlist[w].label, w);
+    for (int v = 0; v < g0.n; v++) {
+        auto it = vertex1.find(g0.adjlist[v].label);
+        if (it != vertex1.end())
+            return {VtxPair(v, it->second)};
+    }
+    return {};
+}
+
+static vector<VtxPair> trivial_solution(const Graph &g0, const Graph &g1) {
+    // isolated vertices can be matched to isolated vertices with the same label, plus one more pair of
+    // non-isolated vertices (which is adjacent to none of them)
+    std::unordered_map<unsigned int, vector<int>> isolated1;
+    std::unordered_map<unsigned int, int> connected1;
+    for (int w = 0; w < g1.n; w++) {
+        if (g1.adjlist[w].adjNodes.empty())
+            isolated1[g1.adjlist[w].label].push_back(w);
+        else
+            connected1.emplace(g1.adjlist[w].label, w);
+    }
+    vector<VtxPair> solution;
+    VtxPair extra(-1, -1);
+    for (int v = 0; v < g0.n; v++) {
+        unsigned int label = g0.adjlist[v].label;
+        if (g0.adjlist[v].adjNodes.empty()) {
+            auto it = isolated1.find(label);
+            if (it != isolated1.end() && !it->second.empty()) {
+                solution.emplace_back(v, it->second.back());
+                it->second.pop_back();
+            }
+        } else if (extra.v == -1) {
+            auto it = connected1.find(label);
+            if (it != connected1.end())
+                extra = VtxPair(v, it->second);
+        }
+    }
+    if (extra.v != -1)
+        solution.push_back(extra);
+    else if (solution.empty())
+        solution = single_vertex_solution(g0, g1);
+    return solution;
+}
+
+static vector<VtxPair> trivial_connected_solution(const Graph &g0, const Graph &g1) {
+    // a single edge with the same pair of labels in both graphs, else a single vertex
+    auto key = [](unsigned int a, unsigned int b) {
+        return a < b ? ((unsigned long long) a << 32) | b : ((unsigned long long) b << 32) | a;
+    };
+    std::unordered_map<unsigned long long, std::pair<int, int>> edges1;
+    for (int x = 0; x < g1.n; x++)
+        for (auto &node: g1.adjlist[x].adjNodes)
+            edges1.emplace(key(g1.adjlist[x].label, g1.adjlist[node.id].label), std::make_pair(x, (int) node.id));
+    for (int u = 0; u < g0.n; u++)
+        for (auto &node: g0.adjlist[u].adjNodes) {
+            int v = node.id;
+            auto it = edges1.find(key(g0.adjlist[u].label, g0.adjlist[v].label));
+            if (it == edges1.end())
+                continue;
+            int x = it->second.first, y = it->second.second;
+            if (g0.adjlist[u].label != g1.adjlist[x].label)
+                std::swap(x, y);
+            return {VtxPair(u, x), VtxPair(v, y)};
+        }
+    return single_vertex_solution(g0, g1);
+}
+
+/**
+ * Cheap bounds, all in O(n + m) expected time:
+ *  - the label-histogram intersection, i.e. the bound of the initial bidomains;
+ *  - in connected mode, the solution lies in one component of each graph and, if it has more than one vertex,
+ *    it only uses vertices of degree >= 1, so the histograms are taken per non-trivial component.
+ * Degree-sequence bounds do not hold for the induced problem (a vertex can lose any number of neighbours),
+ * so the only degree information used is the isolated-vertex one.
+ */
+PreSearchBounds presearch_bounds(const Graph &g0, const Graph &g1, bool connected) {
+    PreSearchBounds bounds;
+    bounds.label_bound = histogram_intersection(count_labels(g0), count_labels(g1));
+    bounds.upper = bounds.label_bound;
+    bounds.component_bound = -1;
+
+    if (connected) {
+        int max_size0, max_size1;
+        label_count max0 = max_component_labels(g0, max_size0);
+        label_count max1 = max_component_labels(g1, max_size1);
+        int non_trivial = std::min(histogram_intersection(max0, max1), std::min(max_size0, max_size1));
+        bounds.component_bound = std::max(non_trivial, std::min(bounds.label_bound, 1));
+        bounds.upper = std::min(bounds.upper, bounds.component_bound);
+        bounds.trivial = trivial_connected_solution(g0, g1);
+    } else {
+        bounds.trivial = trivial_solution(g0, g1);
+    }
+    return bounds;
+}
@@ -0,0 +1,31 @@
+#ifndef MCSPLITDAL_BOUNDS_H
+#define MCSPLITDAL_BOUNDS_H
+
+#include <unordered_map>
+#include <vector>
+#include "graph.h"
+#include "mcs.h"
+
+/**
+ * Bounds computed in O(n + m) before any bidomain is built.
+ */
+struct PreSearchBounds {
+    int label_bound;         // sum over the labels of min(#vertices in g0, #vertices in g1)
+    int component_bound;     // connected mode only, best pair of connected components (-1 otherwise)
+    int upper;               // smallest of the upper bounds above
+    vector<VtxPair> trivial; // a valid solution found without searching
+
+    bool settled() const { return (int) trivial.size() >= upper; }
+};
+
+// number of vertices of each label
+using label_count = std::unordered_map<unsigned int, int>;
+
+label_count count_labels(const Graph &g);
+
+// sum over the labels of the smaller count: the size of the largest label-preserving matching
+int histogram_intersection(const label_count &c0, const label_count &c1);
+
+PreSearchBounds presearch_bounds(const Graph &g0, const Graph &g1, bool connected);
+
+#endif //MCSPLITDAL_BOUNDS_H
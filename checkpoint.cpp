@@ -0,0 +1,402 @@
+#include "checkpoint.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+static const char checkpoint_magic[8] = {'M', 'C', 'S', 'D', 'A', 'L', 'C', '2'};
+
+// the clock is read once every so many nodes
+const unsigned long long checkpoint_check_period = 1024;
+
+static void fail_checkpoint(const char *path, const char *msg) {
+    std::cerr << "Checkpoint " << path << ": " << msg << std::endl;
+    exit(1);
+}
+
+/*
+ * Binary serialisation: plain structs are written as they are, vectors as their size followed by the elements.
+ * Checkpoints are only meant to be read back by the same build on the same machine.
+ */
+
+template<typename T>
+static void write_pod(std::ostream &out, const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value, "not a plain struct");
+    out.write((const char *) &value, sizeof(T));
+}
+
+template<typename T>
+static void write_vector(std::ostream &out, const vector<T> &values) {
+    static_assert(std::is_trivially_copyable<T>::value, "not a plain struct");
+    write_pod(out, (unsigned long long) values.size());
+    out.write((const char *) values.data(), values.size() * sizeof(T));
+}
+
+template<typename T>
+static void read_pod(std::istream &in, T &value) {
+    in.read((char *) &value, sizeof(T));
+}
+
+template<typename T>
+static void read_vector(std::istream &in, vector<T> &values, unsigned long long max_size) {
+    unsigned long long size = 0;
+    read_pod(in, size);
+    if (!in || size > max_size) {
+        in.setstate(std::ios::failbit);
+        return;
+    }
+    values.clear();
+    values.reserve(size);
+    for (unsigned long long i = 0; i < size; i++) {
+        // the elements may have no default constructor (VtxPair, Bidomain)
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        in.read((char *) &storage, sizeof(T));
+        values.push_back(*(T *) &storage);
+    }
+}
+
+unsigned long long graph_pair_fingerprint(const Graph &g0, const Graph &g1) {
+    return graph_fingerprint(g1, graph_fingerprint(g0));
+}
+
+static CheckpointOptions current_options() {
+    CheckpointOptions o;
+    o.connected = arguments.connected;
+    o.twins = arguments.twins;
+    o.big_first = arguments.big_first;
+    o.random_start = arguments.random_start;
+    o.initialize_rewards = arguments.initialize_rewards;
+    o.heuristic = arguments.heuristic;
+    o.mcs_method = arguments.mcs_method;
+    o.max_iter = arguments.max_iter;
+    o.restart_policy = arguments.restart_policy;
+    o.max_restarts = arguments.max_restarts;
+    o.restart_base = arguments.restart_base;
+    o.switch_policy = arguments.reward_policy.switch_policy;
+    o.reward_policies_num = arguments.reward_policy.reward_policies_num;
+    o.current_reward_policy = arguments.reward_policy.current_reward_policy;
+    o.dal_reward_policy = arguments.reward_policy.dal_reward_policy;
+    o.neighbor_overlap = arguments.reward_policy.neighbor_overlap;
+    o.reward_switch_policy_threshold = arguments.reward_policy.reward_switch_policy_threshold;
+    o.reward_coefficient = arguments.reward_policy.reward_coefficient;
+    return o;
+}
+
+// the first option that differs, nullptr if they all match
+static const char *options_mismatch(const CheckpointOptions &a, const CheckpointOptions &b) {
+    if (a.connected != b.connected)
+        return "connected (-c)";
+    if (a.twins != b.twins)
+        return "twins (-y)";
+    if (a.big_first != b.big_first)
+        return "big first (-b)";
+    if (a.random_start != b.random_start)
+        return "random start (-r)";
+    if (a.initialize_rewards != b.initialize_rewards)
+        return "reward initialisation";
+    if (a.heuristic != b.heuristic)
+        return "heuristic";
+    if (a.mcs_method != b.mcs_method)
+        return "mcs method";
+    if (a.max_iter != b.max_iter)
+        return "iteration limit";
+    if (a.restart_policy != b.restart_policy || a.max_restarts != b.max_restarts || a.restart_base != b.restart_base)
+        return "restarts (-R, -n, -m)";
+    if (a.switch_policy != b.switch_policy || a.reward_policies_num != b.reward_policies_num ||
+        a.current_reward_policy != b.current_reward_policy || a.dal_reward_policy != b.dal_reward_policy ||
+        a.neighbor_overlap != b.neighbor_overlap ||
+        a.reward_switch_policy_threshold != b.reward_switch_policy_threshold ||
+        a.reward_coefficient != b.reward_coefficient)
+        return "reward policy";
+    return nullptr;
+}
+
+static void write_checkpoint(const std::string &path, const Checkpoint &c) {
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Cannot write checkpoint " << tmp_path << std::endl;
+            return;
+        }
+        out.write(checkpoint_magic, sizeof(checkpoint_magic));
+        write_pod(out, c.n0);
+        write_pod(out, c.n1);
+        write_pod(out, c.fingerprint);
+        write_pod(out, c.options);
+        write_vector(out, vector<char>(c.sort_heuristic.begin(), c.sort_heuristic.end()));
+
+        write_pod(out, c.search.goal);
+        write_pod(out, c.search.phase);
+        write_pod(out, c.restart_node_limit);
+        write_vector(out, c.search.left);
+        write_vector(out, c.search.right);
+        write_vector(out, c.search.current);
+        write_pod(out, (unsigned long long) c.search.stack.size());
+        vector<int> tried;
+        for (const SearchFrame &f: c.search.stack) {
+            write_vector(out, f.domains);
+            write_pod(out, f.bd_idx);
+            write_pod(out, f.v);
+            write_pod(out, f.w_iter);
+            write_pod(out, f.cur_len);
+            // only the few candidates already tried, not the whole indicator vector
+            tried.clear();
+            for (unsigned int w = 0; w < f.wselected.size(); w++)
+                if (f.wselected[w])
+                    tried.push_back(w);
+            write_vector(out, tried);
+        }
+
+        write_vector(out, c.incumbent);
+        write_pod(out, c.reward_policy);
+        write_vector(out, c.V);
+        for (const vector<Reward> &row: c.Q)
+            write_vector(out, row);
+        write_vector(out, c.SingleQ);
+
+        write_pod(out, c.nodes);
+        write_pod(out, c.cutbranches);
+        write_pod(out, c.conflicts);
+        write_pod(out, c.bestnodes);
+        write_pod(out, c.bestcount);
+        write_pod(out, c.dl);
+        write_pod(out, c.restarts);
+        out.write(checkpoint_magic, sizeof(checkpoint_magic));
+        if (!out) {
+            std::cerr << "Cannot write checkpoint " << tmp_path << std::endl;
+            return;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+        std::cerr << "Cannot replace checkpoint " << path << std::endl;
+}
+
+bool read_checkpoint(const char *path, unsigned long long fingerprint, Checkpoint &c) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        if (errno == ENOENT)
+            return false;
+        fail_checkpoint(path, "cannot be read");
+    }
+    char magic[sizeof(checkpoint_magic)];
+    in.read(magic, sizeof(magic));
+    if (!in || !std::equal(magic, magic + sizeof(magic), checkpoint_magic))
+        fail_checkpoint(path, "not a checkpoint file");
+    read_pod(in, c.n0);
+    read_pod(in, c.n1);
+    read_pod(in, c.fingerprint);
+    if (!in || c.fingerprint != fingerprint)
+        fail_checkpoint(path, "taken on different graphs or with a different vertex order");
+    read_pod(in, c.options);
+    vector<char> name;
+    read_vector(in, name, 1024);
+    c.sort_heuristic.assign(name.begin(), name.end());
+    if (!in)
+        fail_checkpoint(path, "truncated or corrupted");
+    if (c.sort_heuristic != arguments.sort_heuristic->name())
+        fail_checkpoint(path, ("taken with the sort heuristic " + c.sort_heuristic).c_str());
+    if (const char *option = options_mismatch(c.options, current_options()))
+        fail_checkpoint(path, (std::string("taken with a different setting of ") + option).c_str());
+    unsigned long long n0 = c.n0, n1 = c.n1;
+
+    read_pod(in, c.search.goal);
+    read_pod(in, c.search.phase);
+    read_pod(in, c.restart_node_limit);
+    read_vector(in, c.search.left, n0);
+    read_vector(in, c.search.right, n1);
+    read_vector(in, c.search.current, n0);
+    unsigned long long depth = 0;
+    read_pod(in, depth);
+    if (!in || depth > n0 + 1)
+        fail_checkpoint(path, "corrupted search stack");
+    c.search.stack.clear();
+    vector<int> tried;
+    for (unsigned long long i = 0; i < depth && in; i++) {
+        c.search.stack.emplace_back(vector<Bidomain>{});
+        SearchFrame &f = c.search.stack.back();
+        read_vector(in, f.domains, n0);
+        read_pod(in, f.bd_idx);
+        read_pod(in, f.v);
+        read_pod(in, f.w_iter);
+        read_pod(in, f.cur_len);
+        read_vector(in, tried, n1);
+        if (f.bd_idx != -1) {
+            f.wselected.assign(n1, 0);
+            for (int w: tried)
+                if (w >= 0 && (unsigned long long) w < n1)
+                    f.wselected[w] = 1;
+        }
+    }
+
+    read_vector(in, c.incumbent, n0);
+    read_pod(in, c.reward_policy);
+    read_vector(in, c.V, n0);
+    c.Q.assign(n0, {});
+    for (vector<Reward> &row: c.Q)
+        read_vector(in, row, n1);
+    read_vector(in, c.SingleQ, n1);
+
+    read_pod(in, c.nodes);
+    read_pod(in, c.cutbranches);
+    read_pod(in, c.conflicts);
+    read_pod(in, c.bestnodes);
+    read_pod(in, c.bestcount);
+    read_pod(in, c.dl);
+    read_pod(in, c.restarts);
+    in.read(magic, sizeof(magic));
+    if (!in || !std::equal(magic, magic + sizeof(magic), checkpoint_magic))
+        fail_checkpoint(path, "truncated or corrupted");
+
+    // the matched flags follow from the current matching
+    c.search.g0_matched.assign(n0, 0);
+    c.search.g1_matched.assign(n1, 0);
+    for (const VtxPair &pr: c.search.current) {
+        if (pr.v < 0 || pr.v >= c.n0 || pr.w < 0 || pr.w >= c.n1)
+            fail_checkpoint(path, "corrupted matching");
+        c.search.g0_matched[pr.v] = 1;
+        c.search.g1_matched[pr.w] = 1;
+    }
+    return true;
+}
+
+void restore_checkpoint(const Checkpoint &c, Rewards &rewards_base, Stats *stats) {
+    auto &rewards = dynamic_cast<DoubleQRewards &>(rewards_base);
+    rewards.reward_policy = c.reward_policy;
+    rewards.V = c.V;
+    rewards.Q = c.Q;
+    rewards.SingleQ = c.SingleQ;
+    stats->nodes = c.nodes;
+    stats->cutbranches = c.cutbranches;
+    stats->conflicts = c.conflicts;
+    stats->bestnodes = c.bestnodes;
+    stats->bestcount = c.bestcount;
+    stats->dl = c.dl;
+    stats->restarts = c.restarts;
+}
+
+CheckpointWriter::CheckpointWriter(const char *path, int interval, const Graph &g0, const Graph &g1)
+        : path(path), interval(interval), next(std::chrono::steady_clock::now() + this->interval), n0(g0.n),
+          n1(g1.n), fingerprint(graph_pair_fingerprint(g0, g1)), options(current_options()) {
+    thread = std::thread([this] { run(); });
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        stopping = true;
+        cv.notify_all();
+    }
+    thread.join();
+    // the search completed: there is nothing left to resume
+    if (!interrupted)
+        std::remove(path.c_str());
+}
+
+void CheckpointWriter::prepare(Rewards &rewards_base) {
+    auto &rewards = dynamic_cast<DoubleQRewards &>(rewards_base);
+    std::lock_guard<std::mutex> guard(mutex);
+    if (!spare)
+        spare = std::make_unique<Checkpoint>();
+    spare->Q = rewards.Q;
+    rewards.dirty_rows.assign(rewards.Q.size(), 0);
+}
+
+bool CheckpointWriter::due(unsigned long long nodes) {
+    return nodes % checkpoint_check_period == 0 && std::chrono::steady_clock::now() >= next;
+}
+
+void CheckpointWriter::save(SearchState &state, const vector<VtxPair> &incumbent, Rewards &rewards_base,
+                            const Stats *stats, bool final) {
+    next = std::chrono::steady_clock::now() + interval;
+    std::unique_ptr<Checkpoint> c;
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        if (final) {
+            interrupted = true;
+            cv.wait(guard, [this] { return !pending && !writing; });
+        } else if (pending || writing) { // the disk is slower than the interval, skip this one
+            return;
+        }
+        c = std::move(spare);
+    }
+    if (!c)
+        c = std::make_unique<Checkpoint>();
+
+    // the only part done while the search waits: copying its state (into the buffers of the previous checkpoint)
+    auto &rewards = dynamic_cast<DoubleQRewards &>(rewards_base);
+    c->n0 = n0;
+    c->n1 = n1;
+    c->fingerprint = fingerprint;
+    c->options = options;
+    c->sort_heuristic = arguments.sort_heuristic->name();
+    // c holds the previous snapshot: of this state, the frames it still has unchanged do not need to be copied
+    vector<SearchFrame> &frames = c->search.stack;
+    size_t unchanged = std::min(state.unchanged_frames, frames.size());
+    if (frames.size() > state.stack.size())
+        frames.erase(frames.begin() + state.stack.size(), frames.end());
+    for (size_t i = unchanged; i < state.stack.size(); i++) {
+        if (i < frames.size())
+            frames[i] = state.stack[i]; // into the buffers of the old frame
+        else
+            frames.push_back(state.stack[i]);
+    }
+    // the frame on top changes as soon as the search goes on
+    state.unchanged_frames = state.stack.empty() ? 0 : state.stack.size() - 1;
+    c->search.left = state.left;
+    c->search.right = state.right;
+    c->search.current = state.current;
+    c->search.g0_matched = state.g0_matched;
+    c->search.g1_matched = state.g1_matched;
+    c->search.goal = state.goal;
+    c->search.phase = state.phase;
+    c->restart_node_limit = stats->restart_node_limit;
+    c->incumbent = incumbent;
+    c->reward_policy = rewards.reward_policy;
+    c->V = rewards.V;
+    if (rewards.dirty_rows.empty() || c->Q.size() != rewards.Q.size()) {
+        // first snapshot: copy the whole table, and from now on have the rewards flag the rows they change
+        c->Q = rewards.Q;
+        rewards.dirty_rows.assign(rewards.Q.size(), 0);
+    } else {
+        // c holds the previous snapshot
+        for (unsigned int i = 0; i < rewards.Q.size(); i++)
+            if (rewards.dirty_rows[i]) {
+                std::copy(rewards.Q[i].begin(), rewards.Q[i].end(), c->Q[i].begin());
+                rewards.dirty_rows[i] = 0;
+            }
+    }
+    c->SingleQ = rewards.SingleQ;
+    c->nodes = stats->nodes;
+    c->cutbranches = stats->cutbranches;
+    c->conflicts = stats->conflicts;
+    c->bestnodes = stats->bestnodes;
+    c->bestcount = stats->bestcount;
+    c->dl = stats->dl;
+    c->restarts = stats->restarts;
+
+    std::unique_lock<std::mutex> guard(mutex);
+    pending = std::move(c);
+    cv.notify_all();
+    if (final)
+        cv.wait(guard, [this] { return !pending && !writing; });
+}
+
+void CheckpointWriter::run() {
+    std::unique_lock<std::mutex> guard(mutex);
+    while (true) {
+        cv.wait(guard, [this] { return pending || stopping; });
+        if (!pending)
+            return;
+        std::unique_ptr<Checkpoint> c = std::move(pending);
+        writing = true;
+        guard.unlock();
+        write_checkpoint(path, *c);
+        guard.lock();
+        spare = std::move(c);
+        writing = false;
+        cv.notify_all();
+    }
+}
@@ -1,10 +1,13 @@
 #include "graph.h"
+#include "thread_pool.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
 #include <algorithm>
 #include <iostream>
+#include <numeric>
+#include <random>
 #include <string>
 
 constexpr int BITS_PER_UNSIGNED_INT(CHAR_BIT * sizeof(unsigned int));
@@ -25,7 +28,11 @@ Graph::Graph(unsigned int n) {
     this->e = -1;
     for (unsigned int i = 0; i < n; ++i)
         adjlist.emplace_back(i, 0);
-    leaves = std::vector<std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::vector<int>>>> (n);
+    leaf_offset = std::vector<int>(n + 1, 0);
+    leaf_group_start = std::vector<int>(1, 0);
+    twin_class = std::vector<int>(n);
+    std::iota(twin_class.begin(), twin_class.end(), 0);
+    twin_class_size = std::vector<int>(n, 1);
 }
 
 unsigned int Graph::get(const int u, const int v) const {
@@ -40,47 +47,116 @@ unsigned int Graph::get(const int u, const int v) const {
 }
 
 void Graph::pack_leaves() {
-    std::vector<int> deg(this->n, 0);
-
-    for (int i = 0; i < this->n; i++)
-        deg[i] += (int) this->adjlist[i].adjNodes.size();
+    leaf_offset.assign(this->n + 1, 0);
+    leaf_group_label.clear();
+    leaf_group_start.clear();
+    leaf_vertex.clear();
 
+    std::vector<std::pair<unsigned int, int>> leaves; // (label, vertex) for the leaves of u
     for (int u = 0; u < this->n; u++) {
-        for (int v = 0; v < (int) this->adjlist[u].adjNodes.size(); v++)
-            if (deg[v] == 1) {
-                std::pair<unsigned int, unsigned int> labels(1, this->adjlist[v].label);
-                int pos = -1;
-                for (int k = 0;; k++) {
-                    if (k == int(this->leaves[u].size())) {
-                        this->leaves[u].push_back(std::make_pair(labels, std::vector<int>()));
-                    }
-                    if (this->leaves[u][k].first == labels) {
-                        pos = k;
-                        break;
-                    }
-                }
-                //            assert(pos != -1);
-                this->leaves[u][pos].second.push_back(v);
+        leaves.clear();
+        for (auto &node : this->adjlist[u].adjNodes)
+            if (this->adjlist[node.id].adjNodes.size() == 1)
+                leaves.emplace_back(this->adjlist[node.id].label, node.id);
+        std::sort(leaves.begin(), leaves.end());
+        for (unsigned int i = 0; i < leaves.size(); i++) {
+            if (i == 0 || leaves[i].first != leaves[i - 1].first) {
+                leaf_group_label.push_back(leaves[i].first);
+                leaf_group_start.push_back((int) leaf_vertex.size());
             }
-        sort(this->leaves[u].begin(), this->leaves[u].end());
+            leaf_vertex.push_back(leaves[i].second);
+        }
+        leaf_offset[u + 1] = (int) leaf_group_label.size();
+    }
+    leaf_group_start.push_back((int) leaf_vertex.size());
+}
+
+/**
+ * Group the vertices by label and by an order-independent hash of their (open or closed) neighbourhood, then
+ * check the candidates of each group against its first vertex. Hash collisions are left as singletons.
+ * O(m + n log n); a vertex cannot have both a true and a false twin.
+ */
+void Graph::compute_twin_classes() {
+    std::mt19937_64 rng(this->n);
+    std::vector<unsigned long long> key(this->n);
+    for (auto &k : key)
+        k = rng();
+    std::vector<unsigned long long> open_hash(this->n, 0);
+    std::vector<std::vector<int>> neighbours(this->n);
+    for (int v = 0; v < this->n; v++) {
+        for (auto &node : this->adjlist[v].adjNodes) {
+            open_hash[v] += key[node.id];
+            neighbours[v].push_back(node.id);
+        }
+        std::sort(neighbours[v].begin(), neighbours[v].end());
+    }
+
+    std::iota(twin_class.begin(), twin_class.end(), 0);
+    twin_class_size.assign(this->n, 1);
+    std::vector<int> order(this->n);
+    for (bool closed : {false, true}) {
+        auto hash = [&](int v) { return closed ? open_hash[v] + key[v] : open_hash[v]; };
+        auto same_neighbourhood = [&](int u, int v) {
+            if (!closed)
+                return neighbours[u] == neighbours[v];
+            // N(u) - {v} == N(v) - {u}, with u and v adjacent
+            if (neighbours[u].size() != neighbours[v].size() || !std::binary_search(
+                    neighbours[u].begin(), neighbours[u].end(), v))
+                return false;
+            unsigned int i = 0, j = 0;
+            while (i < neighbours[u].size() && j < neighbours[v].size()) {
+                if (neighbours[u][i] == v) { i++; continue; }
+                if (neighbours[v][j] == u) { j++; continue; }
+                if (neighbours[u][i] != neighbours[v][j])
+                    return false;
+                i++, j++;
+            }
+            return true;
+        };
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            if (this->adjlist[a].label != this->adjlist[b].label)
+                return this->adjlist[a].label < this->adjlist[b].label;
+            if (hash(a) != hash(b))
+                return hash(a) < hash(b);
+            return a < b;
+        });
+        for (int start = 0, end; start < this->n; start = end) {
+            int first = order[start];
+            for (end = start + 1; end < this->n && hash(order[end]) == hash(first) &&
+                                  this->adjlist[order[end]].label == this->adjlist[first].label; end++);
+            std::vector<int> members; // members[0] has the smallest id
+            for (int i = start; i < end; i++)
+                if (twin_class_size[order[i]] == 1 && (members.empty() || same_neighbourhood(members[0], order[i])))
+                    members.push_back(order[i]);
+            if (members.size() < 2)
+                continue;
+            for (int u : members) {
+                twin_class[u] = members[0];
+                twin_class_size[u] = (int) members.size();
+            }
+        }
     }
 }
 
 Graph induced_subgraph(struct Graph &g, std::vector<int> vv) {
     Graph subg(g.n);
+    std::vector<int> position(g.n); // inverse of vv
+    for (int i = 0; i < subg.n; ++i)
+        position[vv[i]] = i;
+
+    thread_pool().parallel_for(subg.n, 256, thread_pool().size(), [&](size_t begin, size_t end, int) {
+        for (int i = (int) begin; i < (int) end; ++i) {
+            subg.adjlist[i] = g.adjlist[vv[i]];
+            subg.adjlist[i].id = i;
+            for (int j = 0; j < (int) subg.adjlist[i].adjNodes.size(); ++j) {
+                subg.adjlist[i].adjNodes[j].id = position[subg.adjlist[i].adjNodes[j].id];
+            }
 
-#pragma omp parallel for
-    for (int i = 0; i < subg.n; ++i) {
-        subg.adjlist[i] = g.adjlist[vv[i]];
-        subg.adjlist[i].id = i;
-        for (int j = 0; j < (int) subg.adjlist[i].adjNodes.size(); ++j) {
-            subg.adjlist[i].adjNodes[j].id =
-                    std::find(vv.begin(), vv.end(), subg.adjlist[i].adjNodes[j].id) - vv.begin();
+            std::stable_sort(std::begin(subg.adjlist[i].adjNodes), std::end(subg.adjlist[i].adjNodes),
+                             [&](Node a, Node b) { return a.id < b.id; });
         }
-
-        std::stable_sort(std::begin(subg.adjlist[i].adjNodes), std::end(subg.adjlist[i].adjNodes),
-                         [&](Node a, Node b) { return a.id < b.id; });
-    }
+    });
 
     subg.e = g.e;
     return subg;
@@ -102,6 +178,95 @@ void add_edge(Graph &g, int v, int w, bool directed = false, unsigned int val =
     }
 }
 
+/**
+ * Same vertices and labels, an edge wherever g has none. The adjacency lists are built directly, in increasing
+ * id order and with their final size reserved. The edge count keeps the convention of g.
+ */
+Graph complement(const Graph &g) {
+    Graph c(g.n);
+    std::vector<char> adjacent(g.n, 0);
+    for (int u = 0; u < g.n; u++) {
+        c.adjlist[u].label = g.adjlist[u].label;
+        c.adjlist[u].original_id = g.adjlist[u].original_id;
+        for (auto &node : g.adjlist[u].adjNodes)
+            adjacent[node.id] = 1;
+        c.adjlist[u].adjNodes.reserve(g.n - 1 - g.adjlist[u].adjNodes.size());
+        for (int v = 0; v < g.n; v++)
+            if (v != u && !adjacent[v])
+                c.adjlist[u].adjNodes.emplace_back(v, 0);
+        for (auto &node : g.adjlist[u].adjNodes)
+            adjacent[node.id] = 0;
+    }
+    c.e = g.e < 0 ? -1 : g.n * (g.n - 1) / 2 - g.e;
+    return c;
+}
+
+/**
+ * Vertex sets of the connected components of g with at least min_size vertices, each in increasing order
+ */
+std::vector<std::vector<int>> connected_components(const Graph &g, int min_size) {
+    std::vector<std::vector<int>> components;
+    std::vector<char> seen(g.n, 0);
+    std::vector<int> queue;
+    for (int s = 0; s < g.n; s++) {
+        if (seen[s])
+            continue;
+        queue.assign(1, s);
+        seen[s] = 1;
+        for (size_t head = 0; head < queue.size(); head++)
+            for (auto &node : g.adjlist[queue[head]].adjNodes)
+                if (!seen[node.id]) {
+                    seen[node.id] = 1;
+                    queue.push_back(node.id);
+                }
+        if ((int) queue.size() >= min_size) {
+            std::sort(queue.begin(), queue.end());
+            components.push_back(queue);
+        }
+    }
+    return components;
+}
+
+/**
+ * Subgraph induced by vertices (in increasing order), renumbered 0 .. |vertices| - 1 in that order, so that it
+ * keeps the relative vertex order of g. Leaves and twin classes are left for the caller to compute.
+ */
+Graph vertex_subgraph(const Graph &g, const std::vector<int> &vertices) {
+    Graph sub((unsigned int) vertices.size());
+    std::vector<int> index(g.n, -1);
+    for (unsigned int i = 0; i < vertices.size(); i++)
+        index[vertices[i]] = i;
+    int e = 0;
+    for (unsigned int i = 0; i < vertices.size(); i++) {
+        const Node &node = g.adjlist[vertices[i]];
+        sub.adjlist[i].label = node.label;
+        sub.adjlist[i].original_id = node.original_id;
+        for (auto &adj : node.adjNodes)
+            if (index[adj.id] != -1) {
+                sub.adjlist[i].adjNodes.push_back(adj);
+                sub.adjlist[i].adjNodes.back().id = index[adj.id];
+                e++;
+            }
+    }
+    sub.e = e / 2;
+    return sub;
+}
+
+unsigned long long graph_fingerprint(const Graph &g, unsigned long long h) {
+    // FNV-1a over 64 bit words
+    auto add = [&h](unsigned long long value) {
+        h ^= value;
+        h *= 1099511628211ULL;
+    };
+    add(g.n);
+    for (const Node &node: g.adjlist) {
+        add(node.label);
+        for (const Node &adj: node.adjNodes)
+            add(((unsigned long long) adj.id << 32) | adj.label);
+    }
+    return h;
+}
+
 int Graph::computeNumEdges(){
     int nedges = 0;
     for (int i=0; i<this->n; i++)
@@ -212,7 +377,7 @@ struct Graph readBinaryGraph(char *filename, bool directed, bool edge_labelled,
         fail("Cannot open file");
 
     int nvertices = read_word(f);
-    std::cout << "Nvertices: " << nvertices << std::endl;
+    std::cerr << "Nvertices: " << nvertices << std::endl;
     g = Graph(nvertices);
 
     // Labelling scheme: see
@@ -258,7 +423,7 @@ struct Graph readASCIIGraph(char *filename) {
     if (fscanf(f, "%d %d", &nvertices, &nedges) != 2)
         fail("Number of nodes and edges not read correctly.\n");
 
-    std::cout << "nvertices: " << nvertices << std::endl;
+    std::cerr << "nvertices: " << nvertices << std::endl;
     g = Graph(nvertices);
     int v1, v2;
     for (int i = 0; i < nedges; i++) {
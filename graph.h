@@ -17,7 +17,20 @@ struct Node {
 struct Graph {
     int n, e;
     std::vector<Node> adjlist;
-    std::vector<std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::vector<int>>>> leaves;
+    // Leaf packing in CSR layout. The leaves of u (its neighbours of degree 1) are grouped by label, groups sorted
+    // by label: the groups of u are leaf_offset[u] .. leaf_offset[u + 1] - 1, group k has label leaf_group_label[k]
+    // and vertices leaf_vertex[leaf_group_start[k] .. leaf_group_start[k + 1] - 1].
+    std::vector<int> leaf_offset;
+    std::vector<unsigned int> leaf_group_label;
+    std::vector<int> leaf_group_start;
+    std::vector<int> leaf_vertex;
+
+    // Twin classes: vertices with the same label and the same neighbourhood (false twins, N(u) = N(v)) or the
+    // same closed neighbourhood (true twins, N[u] = N[v]) are interchangeable. twin_class[v] is the smallest
+    // vertex of the class of v, twin_class_size[v] the size of its class. Without compute_twin_classes() every
+    // vertex is alone in its class.
+    std::vector<int> twin_class;
+    std::vector<int> twin_class_size;
 
     Graph(unsigned int n);
 
@@ -25,6 +38,8 @@ struct Graph {
 
     void pack_leaves();
 
+    void compute_twin_classes();
+
     int computeNumEdges();
 
     float computeDensity();
@@ -32,6 +47,15 @@ struct Graph {
 
 Graph induced_subgraph(struct Graph &g, std::vector<int> vv);
 
+Graph complement(const Graph &g);
+
+std::vector<std::vector<int>> connected_components(const Graph &g, int min_size);
+
+Graph vertex_subgraph(const Graph &g, const std::vector<int> &vertices);
+
+// FNV-1a hash of the vertex count, labels and adjacency lists; pass the hash of a previous graph as h to chain
+unsigned long long graph_fingerprint(const Graph &g, unsigned long long h = 14695981039346656037ULL);
+
 Graph readGraph(char *filename, char format, bool directed, bool edge_labelled, bool vertex_labelled);
 
 #endif
@@ -1,12 +1,19 @@
 #include "SortHeuristic.h"
+#include "../thread_pool.h"
 #include <algorithm>
-#include <thread>
-#include <stack>
-#include <queue>
-#include <set>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <sstream>
 
 #define VERBOSE false
 
+// below this many vertices, the iterative heuristics run on one thread
+const int parallel_threshold = 4096;
+// vertices per task of the iterative heuristics
+const size_t chunk_size = 1024;
+
 namespace SortHeuristic {
     vector<int> Degree::sort(const Graph &g) {
         if (VERBOSE) std::cout << "Sorting by degree" << std::endl;
@@ -17,120 +24,265 @@ namespace SortHeuristic {
         return degree;
     }
 
+    // Power iteration pulling the rank of the neighbours over the adjacency lists, O(n + m) per iteration. The
+    // rank of the dangling vertices (no neighbours) goes to every vertex, which is one scalar per iteration.
     vector<int> PageRank::sort(const Graph &g) {
         if (VERBOSE) std::cout << "Sorting by PageRank" << std::endl;
         constexpr float damping_factor = 0.85f;
         constexpr float epsilon = 0.00001f;
-        std::vector<int> out_links = std::vector(g.n, 0);
-        for (int i = 0; i < g.n; i++) {
-            out_links[i] = g.adjlist[i].adjNodes.size();
-        }
-        // create a stochastic matrix (inefficient for big/sparse graphs, could be transformed into adj list (or just use the Graph's internal adj_list?))
-        std::vector<std::vector<float>> stochastic_g = std::vector(g.n, std::vector(g.n, 0.0f));
-        for (int i = 0; i < g.n; i++) {
-            if (!out_links[i]) {
-                for (int j = 0; j < g.n; j++) {
-                    stochastic_g[i][j] = 1.0f / (float) g.n;
-                }
-            } else {
-                for (auto &w: g.adjlist[i].adjNodes) {
-                    stochastic_g[i][w.id] = 1.0f / (float) out_links[i];
-                }
-            }
-        }
-        std::vector<int> result(g.n, 0);
-        std::vector<float> ranks(g.n, 0);
-        std::vector<float> p(g.n, 1.0 / g.n);
-        std::vector<std::vector<float>> transposed = std::vector(g.n, std::vector(g.n, 0.0f));
-        // transpose matrix
-        for (int i = 0; i < g.n; i++) {
-            for (int j = 0; j < g.n; j++) {
-                transposed[i][j] = stochastic_g[j][i];
-            }
+        const int n = g.n;
+        std::vector<float> inv_out_links(n, 0.0f);
+        for (int i = 0; i < n; i++) {
+            if (!g.adjlist[i].adjNodes.empty())
+                inv_out_links[i] = 1.0f / (float) g.adjlist[i].adjNodes.size();
         }
+        std::vector<float> ranks(n, 0);
+        std::vector<float> p(n, 1.0 / n);
+        std::vector<float> contribution(n);
+        // sums are taken per chunk, then added in chunk order, so that the result does not depend on the threads
+        const int lanes = n >= parallel_threshold ? num_threads : 1;
+        std::vector<float> partial((n + chunk_size - 1) / chunk_size);
+        auto total = [&] {
+            float sum = 0.0f;
+            for (float x: partial)
+                sum += x;
+            return sum;
+        };
         while (true) {
-            std::fill(ranks.begin(), ranks.end(), 0);
-            for (int i = 0; i < g.n; i++) {
-                for (int j = 0; j < g.n; j++) {
-                    ranks[i] = ranks[i] + transposed[i][j] * p[j];
+            thread_pool().parallel_for(n, chunk_size, lanes, [&](size_t begin, size_t end, int) {
+                float dangling = 0.0f;
+                for (size_t j = begin; j < end; j++) {
+                    contribution[j] = p[j] * inv_out_links[j];
+                    if (inv_out_links[j] == 0.0f)
+                        dangling += p[j];
                 }
-            }
-            for (int i = 0; i < g.n; i++) {
-                ranks[i] = damping_factor * ranks[i] + (1.0 - damping_factor) / (float) g.n;
-            }
-            float error = 0.0f;
-            for (int i = 0; i < g.n; i++) {
-                error += std::abs(ranks[i] - p[i]);
-            }
-            if (error < epsilon) {
+                partial[begin / chunk_size] = dangling;
+            });
+            const float teleport = (1.0f - damping_factor) / (float) n + damping_factor * total() / (float) n;
+            thread_pool().parallel_for(n, chunk_size, lanes, [&](size_t begin, size_t end, int) {
+                float error = 0.0f;
+                for (size_t i = begin; i < end; i++) {
+                    float sum = 0.0f;
+                    for (auto &w: g.adjlist[i].adjNodes)
+                        sum += contribution[w.id];
+                    ranks[i] = damping_factor * sum + teleport;
+                    error += std::abs(ranks[i] - p[i]);
+                }
+                partial[begin / chunk_size] = error;
+            });
+            if (total() < epsilon) {
                 break;
             }
-
-            for (int i = 0; i < g.n; i++) {
-                p[i] = ranks[i];
-            }
+            p.swap(ranks);
         }
-        for (int i = 0; i < ranks.size(); i++) {
-            result[i] = ranks[i] / epsilon;
+        // the ranks sum to 1: scaled by n they average 1 whatever the size of the graph, and the factor 1000 keeps
+        // three digits of them in the integer scores
+        std::vector<int> result(n, 0);
+        for (int i = 0; i < n; i++) {
+            result[i] = (int) std::min((double) ranks[i] * n * 1000, (double) std::numeric_limits<int>::max());
         }
         return result;
     }
 
     // https://en.wikipedia.org/wiki/Clustering_coefficient
+    // Triangles are counted once, from their lowest vertex in (degree, id) order: each edge is oriented towards
+    // the higher vertex, and the out-lists (sorted by id) of the two ends of each oriented edge are intersected.
+    // Hubs keep short out-lists, so this takes O(m sqrt(m)).
     vector<int> LocalClusteringCoefficient::sort(const Graph &g) {
         if (VERBOSE) std::cout << "Sorting by Local Clustering Coefficient" << std::endl;
-        vector<int> result(g.n, 0);
-        for (int i = 0; i < g.n; i++) {
-            int degree = g.adjlist[i].adjNodes.size();
-            if (degree < 2) {
-                result[i] = 0;
-                continue;
-            }
-            int num_triangles = 0;
-            for (int j = 0; j < degree; j++) {
-                int v = g.adjlist[i].adjNodes[j].id;
-                for (int k = j + 1; k < degree; k++) {
-                    if (g.get(v, g.adjlist[i].adjNodes[k].id) == 1) {
-                        num_triangles++;
+        const int n = g.n;
+        auto before = [&](int u, int v) {
+            size_t du = g.adjlist[u].adjNodes.size(), dv = g.adjlist[v].adjNodes.size();
+            return du < dv || (du == dv && u < v);
+        };
+        vector<int> out_start(n + 1, 0);
+        for (int u = 0; u < n; u++)
+            for (auto &w: g.adjlist[u].adjNodes)
+                if (before(u, w.id))
+                    out_start[u + 1]++;
+        for (int u = 0; u < n; u++)
+            out_start[u + 1] += out_start[u];
+        vector<int> out(out_start[n]);
+        for (int u = 0; u < n; u++) {
+            int k = out_start[u];
+            for (auto &w: g.adjlist[u].adjNodes)
+                if (before(u, w.id))
+                    out[k++] = w.id;
+            std::sort(out.begin() + out_start[u], out.begin() + k);
+        }
+
+        vector<int> num_triangles(n, 0);
+        const int lanes = n >= parallel_threshold ? num_threads : 1;
+        thread_pool().parallel_for(n, 64, lanes, [&](size_t begin, size_t end, int) {
+            for (int u = (int) begin; u < (int) end; u++) {
+                for (int i = out_start[u]; i < out_start[u + 1]; i++) {
+                    int v = out[i];
+                    // common out-neighbours of u and v
+                    int a = out_start[u], b = out_start[v];
+                    while (a < out_start[u + 1] && b < out_start[v + 1]) {
+                        if (out[a] < out[b])
+                            a++;
+                        else if (out[a] > out[b])
+                            b++;
+                        else {
+                            int w = out[a];
+                            std::atomic_ref<int>(num_triangles[u])++;
+                            std::atomic_ref<int>(num_triangles[v])++;
+                            std::atomic_ref<int>(num_triangles[w])++;
+                            a++, b++;
+                        }
                     }
                 }
             }
-            result[i] = 2 * num_triangles * 100 / (degree * (degree - 1));
+        });
+
+        vector<int> result(n, 0);
+        for (int i = 0; i < n; i++) {
+            long long degree = g.adjlist[i].adjNodes.size();
+            if (degree < 2)
+                continue;
+            result[i] = (int) (2LL * num_triangles[i] * 100 / (degree * (degree - 1)));
         }
         return result;
     }
 
-
+    // Katz centrality x = alpha A x + 1 by Jacobi iteration over the adjacency lists, O(n + m) per iteration.
+    // alpha stays below 1 / lambda_max (lambda_max <= the largest degree), so that the series converges.
+    // Every x is 1 plus an attenuated part that holds all the differences between the vertices, so the scores
+    // are that part relative to its maximum, from 0 to 1000000.
     vector<int> KatzCentrality::sort(const Graph &g) {
         if (VERBOSE) std::cout << "Sorting by Katz Centrality" << std::endl;
-        constexpr float alpha = 0.5f;
-        vector<int> result(g.n, 0);
-        for (int i = 0; i < g.n; i++) {
-            vector<int> visited(g.n, 0);
-            vector<double> score(g.n, 0);
-            set<int> next_layer, current_layer;
-            score[i] = 1;
-            next_layer.insert(i);
-            // run BFS
-            while (!next_layer.empty()) {
-                current_layer = next_layer;
-                next_layer.clear();
-                for (auto &v: current_layer) {
-                    for (auto &w: g.adjlist[v].adjNodes) {
-                        if (visited[w.id] == 0) {
-                            score[w.id] += score[v] * alpha;
-                            next_layer.insert(w.id);
-                        }
+        constexpr double attenuation = 0.85;
+        constexpr double epsilon = 0.000001;
+        const int n = g.n;
+        size_t max_degree = 0;
+        for (int i = 0; i < n; i++)
+            max_degree = std::max(max_degree, g.adjlist[i].adjNodes.size());
+        vector<double> x(n, 1.0), next(n);
+        if (max_degree > 0) {
+            const double alpha = attenuation / (double) max_degree;
+            const int lanes = n >= parallel_threshold ? num_threads : 1;
+            vector<double> partial((n + chunk_size - 1) / chunk_size);
+            while (true) {
+                thread_pool().parallel_for(n, chunk_size, lanes, [&](size_t begin, size_t end, int) {
+                    double error = 0.0;
+                    for (size_t i = begin; i < end; i++) {
+                        double sum = 0.0;
+                        for (auto &w: g.adjlist[i].adjNodes)
+                            sum += x[w.id];
+                        next[i] = alpha * sum + 1.0;
+                        error += std::abs(next[i] - x[i]);
                     }
+                    partial[begin / chunk_size] = error;
+                });
+                x.swap(next);
+                double error = 0.0;
+                for (double e: partial)
+                    error += e;
+                if (error < epsilon * n)
+                    break;
+            }
+        }
+        double max_attenuated = 0.0;
+        for (int i = 0; i < n; i++)
+            max_attenuated = std::max(max_attenuated, x[i] - 1.0);
+        vector<int> result(n, 0);
+        if (max_attenuated > 0.0)
+            for (int i = 0; i < n; i++)
+                result[i] = (int) ((x[i] - 1.0) / max_attenuated * 1000000);
+        return result;
+    }
+
+    // Batagelj and Zaversnik: vertices bucketed by current degree, always removing one of the lowest degree
+    static vector<int> core_numbers(const Graph &g) {
+        const int n = g.n;
+        vector<int> degree(n);
+        int max_degree = 0;
+        for (int v = 0; v < n; v++) {
+            degree[v] = (int) g.adjlist[v].adjNodes.size();
+            max_degree = std::max(max_degree, degree[v]);
+        }
+        // vertices sorted by degree, with bin_start[d] the position of the first vertex of degree d
+        vector<int> bin_start(max_degree + 2, 0);
+        for (int v = 0; v < n; v++)
+            bin_start[degree[v] + 1]++;
+        for (int d = 0; d <= max_degree; d++)
+            bin_start[d + 1] += bin_start[d];
+        vector<int> vertices(n), position(n);
+        {
+            vector<int> next(bin_start.begin(), bin_start.end() - 1);
+            for (int v = 0; v < n; v++) {
+                position[v] = next[degree[v]]++;
+                vertices[position[v]] = v;
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            int v = vertices[i];
+            for (auto &w: g.adjlist[v].adjNodes) {
+                int u = w.id;
+                if (degree[u] <= degree[v])
+                    continue;
+                // move u to the front of its bin, then shift the bin boundary past it
+                int d = degree[u];
+                int first = vertices[bin_start[d]];
+                if (first != u) {
+                    std::swap(vertices[bin_start[d]], vertices[position[u]]);
+                    position[first] = position[u];
+                    position[u] = bin_start[d];
                 }
-                for (auto &w: next_layer) {
-                    visited[w] = 1;
-                }
+                bin_start[d]++;
+                degree[u]--;
             }
-            double sum = 0;
-            for (int j = 0; j < g.n; j++)
-                sum += score[j] * 10;
-            result[i] = (int) sum;
+        }
+        return degree;
+    }
+
+    vector<int> CoreNumber::sort(const Graph &g) {
+        if (VERBOSE) std::cout << "Sorting by core number" << std::endl;
+        return core_numbers(g);
+    }
+
+    vector<int> TwoHopDegree::sort(const Graph &g) {
+        if (VERBOSE) std::cout << "Sorting by 2-hop degree" << std::endl;
+        vector<int> result(g.n, 0);
+        for (int v = 0; v < g.n; v++) {
+            long long sum = 0;
+            for (auto &w: g.adjlist[v].adjNodes)
+                sum += g.adjlist[w.id].adjNodes.size();
+            result[v] = (int) std::min<long long>(sum, std::numeric_limits<int>::max());
+        }
+        return result;
+    }
+
+    // two stable counting sorts (by degree, then by core number) give the order of the pairs in O(n + max degree)
+    vector<int> CoreThenDegree::sort(const Graph &g) {
+        if (VERBOSE) std::cout << "Sorting by core number, then degree" << std::endl;
+        const int n = g.n;
+        vector<int> core = core_numbers(g);
+        vector<int> degree(n);
+        int max_degree = 0;
+        for (int v = 0; v < n; v++) {
+            degree[v] = (int) g.adjlist[v].adjNodes.size();
+            max_degree = std::max(max_degree, degree[v]);
+        }
+        auto counting_sort = [&](const vector<int> &in, const vector<int> &key) {
+            vector<int> start(max_degree + 2, 0);
+            for (int v: in)
+                start[key[v] + 1]++;
+            for (int k = 0; k <= max_degree; k++)
+                start[k + 1] += start[k];
+            vector<int> out(in.size());
+            for (int v: in)
+                out[start[key[v]]++] = v;
+            return out;
+        };
+        vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        order = counting_sort(counting_sort(order, degree), core);
+        vector<int> result(n, 0);
+        for (int i = 1; i < n; i++) {
+            int u = order[i - 1], v = order[i];
+            result[v] = result[u] + (core[u] != core[v] || degree[u] != degree[v]);
         }
         return result;
     }
@@ -140,59 +292,70 @@ namespace SortHeuristic {
     ///////////////////////////
 
 
-    vector<int> Parallel::sort(const Graph &g) {
+    int Parallel::num_pivots(int n) const {
+        if (samples > 0)
+            return std::min(samples, n);
+        if (epsilon > 0 && n > 0)
+            return (int) std::min((double) n, std::ceil(std::log(2.0 * n / delta) / (2 * epsilon * epsilon)));
+        return n;
+    }
 
-        std::vector<std::thread> threads;
-        std::atomic<size_t> index;
-        BC_.resize(g.n);
-        std::fill(begin(BC_), end(BC_), 0.0);
+    string Parallel::sampling_suffix() const {
+        std::ostringstream suffix;
+        if (samples > 0)
+            suffix << "(samples=" << samples << ")";
+        else if (epsilon > 0)
+            suffix << "(approx=" << epsilon << ")";
+        return suffix.str();
+    }
 
-        index.store(g.n - 1);
+    vector<int> Parallel::sort(const Graph &g) {
 
-        // run threads
-        for (size_t i = 0; i < num_threads - 1; i++)
-            threads.emplace_back(std::thread([this, &index, &g] { run_worker(&index, g); }));
+        std::atomic<size_t> index;
+        std::mutex bc_mutex;
+        std::vector<double> BC(g.n, 0.0);
+
+        // every vertex, or the first K of a random permutation (fixed seed, so that runs are reproducible)
+        std::vector<int> sources(g.n);
+        std::iota(sources.begin(), sources.end(), 0);
+        int pivots = num_pivots(g.n);
+        bool sampled = pivots < g.n;
+        if (sampled) {
+            std::mt19937 rng(0);
+            for (int i = 0; i < pivots; i++)
+                std::swap(sources[i], sources[i + rng() % (g.n - i)]);
+            sources.resize(pivots);
+        }
 
-        // start working
-        run_worker(&index, g);
+        index.store(sources.size() - 1);
 
-        // wait for others to finish
-        for (auto &thread: threads)
-            thread.join();
-        vector<int> results = get_result_vector();
+        thread_pool().run_lanes(num_threads, [&](int) { run_worker(&index, g, &sources, sampled, &BC, &bc_mutex); });
+        if (sampled)
+            for (double &score: BC)
+                score *= (double) g.n / pivots;
+        vector<int> results = get_result_vector(BC);
         return results;
     }
 
     // Adapted from https://github.com/chivay/betweenness-centrality
-    void BetweennessCentrality::process(const Graph &g, const size_t &vertex_id, std::vector<double> *BC_local) {
-        size_t vec_size = BC_local->size();
-        std::stack<size_t> S;
-        std::vector<std::vector<size_t> > P(vec_size);
-        std::vector<int> sigma(vec_size);
-        std::vector<int> d(vec_size);
-        std::vector<double> delta(vec_size);
-
-        for (size_t w = 0; w < g.n; w++) {
-            sigma[w] = 0;
-            d[w] = -1;
-            delta[w] = 0;
-        }
+    void BetweennessCentrality::process(const Graph &g, const size_t &vertex_id, std::vector<double> *BC_local,
+                                        Workspace &ws) {
+        std::vector<int> &Q = ws.queue; // also the stack S: vertices by non-decreasing distance
+        std::vector<int> &d = ws.distance;
+        std::vector<double> &sigma = ws.sigma;
+        std::vector<double> &delta = ws.delta;
+        std::vector<std::vector<int>> &P = ws.predecessors;
 
         sigma[vertex_id] = 1;
         d[vertex_id] = 0;
+        Q.assign(1, (int) vertex_id);
 
-        std::queue<size_t> Q;
-        Q.push(vertex_id);
-
-        while (!Q.empty()) {
-            size_t v = Q.front();
-            Q.pop();
-            S.push(v);
-
+        for (size_t head = 0; head < Q.size(); head++) {
+            int v = Q[head];
             for (const auto &node: g.adjlist[v].adjNodes) {
-                size_t w = node.id;
+                int w = node.id;
                 if (d[w] < 0) {
-                    Q.push(w);
+                    Q.push_back(w);
                     d[w] = d[v] + 1;
                 }
 
@@ -203,79 +366,63 @@ namespace SortHeuristic {
             }
         }
 
-        while (!S.empty()) {
-            size_t v = S.top();
-            S.pop();
-
-            for (size_t p: P[v]) {
-                double result = (double(sigma[p]) / sigma[v]) * (1.0 + delta[v]);
+        for (size_t i = Q.size(); i-- > 0;) {
+            int v = Q[i];
+            for (int p: P[v]) {
+                double result = (sigma[p] / sigma[v]) * (1.0 + delta[v]);
                 delta[p] += result;
             }
 
-            if (v != vertex_id) {
+            if (v != (int) vertex_id) {
                 (*BC_local)[v] += delta[v];
             }
         }
-    }
 
-    // Adapted from https://github.com/konstantinNovichenko/Modified-Dijkstra-Centrality-Closeness-Betweenness
-    // Our version is multi threaded and does not support weighted graphs
-    void ClosenessCentrality::process(const Graph &g, const size_t &vertex_id, std::vector<double> *BC_local) {
-        int s, Minimum, u, infinity, temp[g.n], centralityScore = 0;;
-        std::vector<bool> T = std::vector<bool>(g.n);//Nodes to be visted
-        std::vector<int> L = std::vector<int>(g.n);//lambda
-        std::vector<int> father = std::vector<int>(g.n);
-
-        infinity = 1000;
-        s = (int) vertex_id;
-
-        //INITIALIZING DATA STRUCTURES
-        for (int j = 0; j < g.n; j++) {
-            T[j] = false;            //T=V; all the vertices are eligible to be visited
-            L[j] = infinity;            // at the beginning every vertex is at distance ?, from s
-            temp[j] = infinity;
-            father[j] = -1;
+        // only the reached vertices were touched
+        for (int v: Q) {
+            d[v] = -1;
+            sigma[v] = 0;
+            delta[v] = 0;
+            P[v].clear();
         }
-        //WE ASSUME THE SOURCE IS 0 FOR EVERY GRAPH
-        L[s] = 0;                    // s is at distance 0 of itself
-        temp[s] = 0;                // Temp has the same contents of L
-
-        // Let u be the vertex in T that has minimum L clearly at the beginning u=s
-        for (int j = 0; j < g.n; j++) {                //LOOP TROUGH ALL THE VERTICES OF THE GRAPH
-            //cout<<endl<<"STEP "<<i<<":\n________ ";
-            Minimum = infinity;
-            for (int k = 0; k < g.n; k++) {
-                if (T[k] == 0) {
-                    if (Minimum > temp[k]) {
-                        Minimum = temp[k];            //finding minimum L[s]
-                        u = k;
-                    }
-                }
-            }
-            temp[u] = infinity;                //Assigning INFINITY to the data structure already visited to find the next minimum L
-            for (int k = 0; k < g.adjlist[u].adjNodes.size(); k++) {
-                const Node *w = &g.adjlist[u].adjNodes[k];
-                if (!T[w->id]) {       // if w Exist in T, proceed
-                    if (L[w->id] > L[u] + 1) {
-                        L[w->id] = L[u] + 1; // w is closer to s by using u;
-                        temp[w->id] = L[w->id];
-                        father[w->id] = u;
-                    }
+    }
+
+    // Harmonic closeness 10 * sum(1 / d(s, v)) / (n - 1) from a BFS: unreachable vertices add 0, so that
+    // disconnected graphs are handled. Distances are symmetric, so a sampled pivot s adds its term 1 / d(s, v)
+    // to every vertex v it reaches instead.
+    void ClosenessCentrality::process(const Graph &g, const size_t &vertex_id, std::vector<double> *BC_local,
+                                      Workspace &ws) {
+        std::vector<int> &Q = ws.queue;
+        std::vector<int> &d = ws.distance;
+        d[vertex_id] = 0;
+        Q.assign(1, (int) vertex_id);
+        double harmonic = 0.0;
+        for (size_t head = 0; head < Q.size(); head++) {
+            int v = Q[head];
+            for (const auto &node: g.adjlist[v].adjNodes) {
+                if (d[node.id] < 0) {
+                    d[node.id] = d[v] + 1;
+                    if (ws.sampled && g.n > 1)
+                        (*BC_local)[node.id] += 10.0 / d[node.id] / (g.n - 1);
+                    else
+                        harmonic += 1.0 / d[node.id];
+                    Q.push_back(node.id);
                 }
             }
-            T[u] = true;                //Discard visited vertex u from T
-        }
-
-        for (int j = 0; j < g.n; j++) {
-            centralityScore += L[j]; // get the total distance from the vertex to other vertices
         }
+        for (int v: Q)
+            d[v] = -1;
 
-        (*BC_local)[vertex_id] = 1.0 / (double) centralityScore * 10 * g.n; // push to the list of all centrality scores
+        if (!ws.sampled && g.n > 1)
+            (*BC_local)[vertex_id] = 10 * harmonic / (g.n - 1);
     }
 
-    void Parallel::run_worker(std::atomic<size_t> *idx, const Graph &g) {
+    void Parallel::run_worker(std::atomic<size_t> *idx, const Graph &g, const std::vector<int> *sources, bool sampled,
+                              std::vector<double> *BC, std::mutex *bc_mutex) {
         std::vector<double> BC_local(g.n);
         std::fill(begin(BC_local), end(BC_local), 0.0);
+        Workspace ws(g.n);
+        ws.sampled = sampled;
 
         while (true) {
             int my_index = (int) (*idx)--;
@@ -283,24 +430,24 @@ namespace SortHeuristic {
             if (my_index < 0)
                 break;
 
-            process(g, my_index, &BC_local);
+            process(g, (*sources)[my_index], &BC_local, ws);
         }
 
         // Synchronized section
         {
-            std::lock_guard<std::mutex> guard(bc_mutex_);
+            std::lock_guard<std::mutex> guard(*bc_mutex);
             for (size_t i = 0; i < BC_local.size(); i++) {
-                BC_[i] += BC_local[i];
+                (*BC)[i] += BC_local[i];
             }
         }
     }
 
-    std::vector<int> Parallel::get_result_vector() const {
+    std::vector<int> Parallel::get_result_vector(const std::vector<double> &BC) {
         std::vector<int> results;
-        results.resize(BC_.size());
+        results.resize(BC.size());
 
-        for (size_t i = 0; i < BC_.size(); i++) {
-            results[i] = static_cast<int>(BC_[i] * 100);
+        for (size_t i = 0; i < BC.size(); i++) {
+            results[i] = static_cast<int>(BC[i] * 100);
         }
         return results;
     }
@@ -43,30 +43,88 @@ namespace SortHeuristic {
         vector<int> sort(const Graph &g) override;
     };
 
+    /**
+     * Degeneracy ordering: the score is the core number, the largest k such that the vertex belongs to the k-core
+     * (the subgraph left after repeatedly removing the vertices of degree below k). O(n + m) by bucket peeling.
+     */
+    class CoreNumber : public Base {
+    public:
+        string name() override {return "CoreNumber";};
+        vector<int> sort(const Graph &g) override;
+    };
+
+    /**
+     * Sum of the degrees of the neighbours (the number of walks of length 2), one step of the power iteration
+     * of eigenvector centrality started from the degrees. O(n + m).
+     */
+    class TwoHopDegree : public Base {
+    public:
+        string name() override {return "TwoHopDegree";};
+        vector<int> sort(const Graph &g) override;
+    };
+
+    /**
+     * Core number, ties broken by degree: the score is the rank of the (core number, degree) pair. O(n + m).
+     */
+    class CoreThenDegree : public Base {
+    public:
+        string name() override {return "CoreThenDegree";};
+        vector<int> sort(const Graph &g) override;
+    };
+
     /////////////// Parallel Heuristics ///////////////
 
+    // buffers of one worker, sized for the graph once and reused for every source it processes
+    struct Workspace {
+        std::vector<int> queue;    // BFS order
+        std::vector<int> distance; // -1 when not reached
+        std::vector<double> sigma;
+        std::vector<double> delta;
+        std::vector<std::vector<int>> predecessors;
+        bool sampled = false; // the source is a sampled pivot, see Parallel
+
+        explicit Workspace(int n) : distance(n, -1), sigma(n, 0.0), delta(n, 0.0), predecessors(n) {
+            queue.reserve(n);
+        }
+    };
+
+    /**
+     * Heuristics made of one independent computation per source vertex. In the approximate mode only a random
+     * sample of K pivot sources is processed and the accumulated scores are scaled by n / K. K is either given
+     * or derived from an additive error epsilon with probability 1 - delta: K = ceil(ln(2n / delta) / (2 eps^2)),
+     * at most n.
+     */
     class Parallel : public Base {
     public:
         vector<int> sort(const Graph &g) override;
-        [[nodiscard]] vector<int> get_result_vector() const;
+        [[nodiscard]] static vector<int> get_result_vector(const std::vector<double> &BC);
+        void set_approximation(double epsilon_) { epsilon = epsilon_; samples = 0; }
+        void set_samples(int samples_) { samples = samples_; epsilon = 0; }
+        // number of pivots for a graph of n vertices (n in the exact mode)
+        [[nodiscard]] int num_pivots(int n) const;
+    protected:
+        double epsilon = 0;
+        int samples = 0;
+        static constexpr double delta = 0.1;
+        // "(approx=...)" or "(samples=...)" in the approximate mode, for name()
+        [[nodiscard]] string sampling_suffix() const;
     private:
-        virtual void process(const Graph &g, const size_t &vertex_id, std::vector<double> *BC_local) {cout << "Warning: no parallel sort is selected!" << endl;}
-        void run_worker(std::atomic<size_t> *idx, const Graph &g);
-        std::mutex bc_mutex_;
-        std::vector<double> BC_;
-        std::string type_;
+        virtual void process(const Graph &g, const size_t &vertex_id, std::vector<double> *BC_local, Workspace &ws) {cout << "Warning: no parallel sort is selected!" << endl;}
+        // the accumulator is owned by sort(), so that the same heuristic can sort several graphs concurrently
+        void run_worker(std::atomic<size_t> *idx, const Graph &g, const std::vector<int> *sources, bool sampled,
+                        std::vector<double> *BC, std::mutex *bc_mutex);
     };
 
     class BetweennessCentrality : public Parallel {
     public:
-        string name() override {return "BetweennessCentrality";};
-        void process(const Graph &g, const size_t &vertex_id, std::vector<double> *BC_local) override;
+        string name() override {return "BetweennessCentrality" + sampling_suffix();};
+        void process(const Graph &g, const size_t &vertex_id, std::vector<double> *BC_local, Workspace &ws) override;
     };
 
     class ClosenessCentrality : public Parallel {
     public:
-        string name() override {return "ClosenessCentrality";};
-        void process(const Graph &g, const size_t &vertex_id, std::vector<double> *BC_local) override;
+        string name() override {return "ClosenessCentrality" + sampling_suffix();};
+        void process(const Graph &g, const size_t &vertex_id, std::vector<double> *BC_local, Workspace &ws) override;
     };
 
 }
@@ -0,0 +1,58 @@
+#include "incumbent_stream.h"
+
+#include <iostream>
+#include "./nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+IncumbentStream::IncumbentStream(const std::string &path) : owned(false), start(std::chrono::steady_clock::now()) {
+    if (path == "-") {
+        file = stdout;
+    } else if (path.rfind("fd:", 0) == 0) {
+        file = fdopen(std::stoi(path.substr(3)), "w");
+    } else {
+        file = fopen(path.c_str(), "w");
+        owned = true;
+    }
+    if (!file) {
+        std::cerr << "Cannot open incumbent stream " << path << std::endl;
+        exit(1);
+    }
+}
+
+IncumbentStream::~IncumbentStream() {
+    if (owned)
+        fclose(file);
+    else
+        fflush(file);
+}
+
+void IncumbentStream::set_vertex_order(const vector<int> &order0, const vector<int> &order1, bool swapped) {
+    this->order0 = order0;
+    this->order1 = order1;
+    this->swapped = swapped;
+}
+
+void IncumbentStream::write(const vector<VtxPair> &incumbent, unsigned long long nodes, int bound) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if ((long long) incumbent.size() <= written)
+        return;
+    written = incumbent.size();
+    json mapping = json::array();
+    for (const VtxPair &p: incumbent) {
+        int v = order0.empty() ? p.v : order0[p.v];
+        int w = order1.empty() ? p.w : order1[p.w];
+        if (swapped)
+            std::swap(v, w);
+        mapping.push_back({v, w});
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    json record = {{"size",    incumbent.size()},
+                   {"time_ms", std::chrono::duration<double, std::milli>(elapsed).count()},
+                   {"nodes",   nodes},
+                   {"bound",   bound},
+                   {"mapping", mapping}};
+    std::string line = record.dump() + "\n";
+    fputs(line.c_str(), file);
+    fflush(file);
+}
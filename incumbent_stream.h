@@ -0,0 +1,38 @@
+#ifndef MCSPLITDAL_INCUMBENT_STREAM_H
+#define MCSPLITDAL_INCUMBENT_STREAM_H
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "mcs.h"
+
+/**
+ * Writes every new incumbent as a JSON line as soon as it is found, so that a killed job does not lose its best
+ * solution. Each record has the mapping (indices of the original input graphs), the elapsed wall time, the node
+ * count and the current global upper bound.
+ */
+class IncumbentStream {
+public:
+    // path is a file (or named pipe), "-" for stdout or "fd:N" for an already open file descriptor
+    explicit IncumbentStream(const std::string &path);
+    ~IncumbentStream();
+
+    // map the vertices of the searched (sorted, possibly swapped) graphs back to the input graphs
+    void set_vertex_order(const vector<int> &order0, const vector<int> &order1, bool swapped);
+
+    // thread-safe; an incumbent that is not larger than the last one written is skipped
+    void write(const vector<VtxPair> &incumbent, unsigned long long nodes, int bound);
+
+private:
+    FILE *file;
+    bool owned;
+    std::chrono::steady_clock::time_point start;
+    vector<int> order0, order1;
+    bool swapped = false;
+    std::mutex mutex;
+    long long written = -1; // size of the last incumbent written
+};
+
+#endif //MCSPLITDAL_INCUMBENT_STREAM_H
@@ -1,13 +1,22 @@
 #include <iostream>
 #include <algorithm>
 #include <set>
+#include <cmath>
+#include <mutex>
 #include "mcs.h"
 #include "reward.h"
+#include "bounds.h"
+#include "warm_start.h"
+#include "checkpoint.h"
+#include "incumbent_stream.h"
+#include "subgraph_iso.h"
+#include "thread_pool.h"
 
 using namespace std;
 
 const int short_memory_threshold = 1e5;
 const int long_memory_threshold = 1e9;
+const double geometric_restart_factor = 1.5;
 
 void show(const vector<VtxPair> &current, const vector<Bidomain> &domains,
           const vector<int> &left, const vector<int> &right, Stats *stats) {
@@ -41,6 +50,64 @@ int calc_bound(const vector<Bidomain> &domains) {
     return bound;
 }
 
+// add to reachable[i] the vertices of bidomain i that a BFS from the adjacent bidomains reaches, on one side
+static void count_reachable(const vector<Bidomain> &domains, const vector<int> &vv, bool left_side, const Graph &g,
+                            vector<int> &bd_of, vector<int> &queue, int *reachable) {
+    if (bd_of.size() != (size_t) g.n)
+        bd_of.assign(g.n, -1);
+    queue.clear();
+    for (unsigned int i = 0; i < domains.size(); i++) {
+        const Bidomain &bd = domains[i];
+        int start = left_side ? bd.l : bd.r, len = left_side ? bd.left_len : bd.right_len;
+        for (int j = start; j < start + len; j++) {
+            if (bd.is_adjacent) {
+                queue.push_back(vv[j]);
+                reachable[i]++;
+            } else
+                bd_of[vv[j]] = i;
+        }
+    }
+    for (size_t head = 0; head < queue.size(); head++)
+        for (auto &node: g.adjlist[queue[head]].adjNodes) {
+            int i = bd_of[node.id];
+            if (i >= 0) {
+                bd_of[node.id] = -1;
+                reachable[i]++;
+                queue.push_back(node.id);
+            }
+        }
+    // unmark the vertices the BFS did not reach
+    for (const Bidomain &bd: domains) {
+        if (bd.is_adjacent)
+            continue;
+        int start = left_side ? bd.l : bd.r, len = left_side ? bd.left_len : bd.right_len;
+        for (int j = start; j < start + len; j++)
+            bd_of[vv[j]] = -1;
+    }
+}
+
+/**
+ * Bound of the connected variant for a non-empty matching. A vertex can only join the matching later through a
+ * path of vertices still in the bidomains that starts next to the matching, i.e. in an adjacent bidomain. So
+ * each bidomain only counts min(reachable left vertices, reachable right vertices), after a BFS on each side.
+ */
+int calc_connected_bound(const vector<Bidomain> &domains, const Graph &g0, const Graph &g1, SearchState &s) {
+    bool all_adjacent = true;
+    for (const Bidomain &bd: domains)
+        all_adjacent = all_adjacent && bd.is_adjacent;
+    if (all_adjacent) // nothing to gain on calc_bound()
+        return calc_bound(domains);
+
+    int k = domains.size();
+    s.reachable.assign(2 * k, 0);
+    count_reachable(domains, s.left, true, g0, s.left_bd, s.queue, &s.reachable[0]);
+    count_reachable(domains, s.right, false, g1, s.right_bd, s.queue, &s.reachable[k]);
+    int bound = 0;
+    for (int i = 0; i < k; i++)
+        bound += std::min(s.reachable[i], s.reachable[k + i]);
+    return bound;
+}
+
 int selectV_index(const vector<int> &arr, const Rewards &rewards, int start_idx, int len) {
     int idx = -1;
     gtype max_g = -1;
@@ -148,22 +215,23 @@ generate_new_domains(const vector<Bidomain> &d, int bd_idx, vector<VtxPair> &cur
     g0_matched[v] = 1;
     g1_matched[w] = 1;
 
+    // match the leaves of v with the leaves of w that have the same label
     int leaves_match_size = 0, v_leaf, w_leaf;
-    for (unsigned int i = 0, j = 0; i < g0.leaves[v].size() && j < g1.leaves[w].size();) {
-        if (g0.leaves[v][i].first < g1.leaves[w][j].first)
+    for (int i = g0.leaf_offset[v], j = g1.leaf_offset[w]; i < g0.leaf_offset[v + 1] && j < g1.leaf_offset[w + 1];) {
+        if (g0.leaf_group_label[i] < g1.leaf_group_label[j])
             i++;
-        else if (g0.leaves[v][i].first > g1.leaves[w][j].first)
+        else if (g0.leaf_group_label[i] > g1.leaf_group_label[j])
             j++;
         else {
-            const vector<int> &leaf0 = g0.leaves[v][i].second;
-            const vector<int> &leaf1 = g1.leaves[w][j].second;
-            for (unsigned int p = 0, q = 0; p < leaf0.size() && q < leaf1.size();) {
-                if (g0_matched[leaf0[p]])
+            int p = g0.leaf_group_start[i], p_end = g0.leaf_group_start[i + 1];
+            int q = g1.leaf_group_start[j], q_end = g1.leaf_group_start[j + 1];
+            while (p < p_end && q < q_end) {
+                if (g0_matched[g0.leaf_vertex[p]])
                     p++;
-                else if (g1_matched[leaf1[q]])
+                else if (g1_matched[g1.leaf_vertex[q]])
                     q++;
                 else {
-                    v_leaf = leaf0[p], w_leaf = leaf1[q];
+                    v_leaf = g0.leaf_vertex[p], w_leaf = g1.leaf_vertex[q];
                     p++, q++;
                     current.push_back(VtxPair(v_leaf, w_leaf));
                     g0_matched[v_leaf] = 1;
@@ -179,25 +247,25 @@ generate_new_domains(const vector<Bidomain> &d, int bd_idx, vector<VtxPair> &cur
     new_d.reserve(d.size());
     int l, r, j = -1;
     int temp, total = 0;
-    int unmatched_left_len, unmatched_right_len;
     for (const Bidomain &old_bd: d) {
         j++;
         l = old_bd.l;
         r = old_bd.r;
-        if (leaves_match_size > 0 && old_bd.is_adjacent == false) {
-            unmatched_left_len = remove_matched_vertex(left, l, old_bd.left_len, g0_matched);
-            unmatched_right_len = remove_matched_vertex(right, r, old_bd.right_len, g1_matched);
-        } else {
-            unmatched_left_len = old_bd.left_len;
-            unmatched_right_len = old_bd.right_len;
-        }
-        // After these two partitions, left_len and right_len are the lengths of the
+        // After these two partitions, left_adj_len and right_adj_len are the lengths of the
         // arrays of vertices with edges from v or w (int the directed case, edges
         // either from or to v or w)
-        int left_len = partition(left, l, unmatched_left_len, g0, v);
-        int right_len = partition(right, r, unmatched_right_len, g1, w);
-        int left_len_noedge = unmatched_left_len - left_len;
-        int right_len_noedge = unmatched_right_len - right_len;
+        int left_adj_len = partition(left, l, old_bd.left_len, g0, v);
+        int right_adj_len = partition(right, r, old_bd.right_len, g1, w);
+        int left_len_noedge = old_bd.left_len - left_adj_len;
+        int right_len_noedge = old_bd.right_len - right_adj_len;
+        int left_len = left_adj_len;
+        int right_len = right_adj_len;
+        if (leaves_match_size > 0 && old_bd.is_adjacent == false) {
+            // the matched leaves are neighbours of v and w, so they can only be in the adjacent parts:
+            // move them to the end of these parts, where they belong to no bidomain
+            left_len = remove_matched_vertex(left, l, left_adj_len, g0_matched);
+            right_len = remove_matched_vertex(right, r, right_adj_len, g1_matched);
+        }
 
         // compute reward
         temp = std::min(old_bd.left_len, old_bd.right_len) - std::min(left_len, right_len) -
@@ -212,7 +280,8 @@ generate_new_domains(const vector<Bidomain> &d, int bd_idx, vector<VtxPair> &cur
         cout << "gl=" << lgrade[v] << " gr=" << rgrade[w] << endl;
 #endif
         if (left_len_noedge && right_len_noedge)
-            new_d.push_back({l + left_len, r + right_len, left_len_noedge, right_len_noedge, old_bd.is_adjacent});
+            new_d.push_back({l + left_adj_len, r + right_adj_len, left_len_noedge, right_len_noedge,
+                             old_bd.is_adjacent});
         if (multiway && left_len && right_len) {
             auto l_begin = std::begin(left) + l;
             auto r_begin = std::begin(right) + r;
@@ -293,7 +362,7 @@ int selectW_index(const Graph &g0, const Graph &g1, const vector<VtxPair> &curre
     int vtx, best_vtx = INT_MAX;
     for (int i = 0; i < len; i++) {
         vtx = arr[start_idx + i];
-        if (wselected[vtx] == 0) {
+        if (wselected[g1.twin_class[vtx]] == 0) { // one candidate per twin class
             gtype pair_reward = 0;
             // Compute overlap scores
             if (arguments.reward_policy.neighbor_overlap != NO_OVERLAP) {
@@ -324,120 +393,340 @@ void remove_vtx_from_array(vector<int> &arr, int start_idx, int &len, int remove
     std::swap(arr[start_idx + remove_idx], arr[start_idx + len]);
 }
 
+// remove the unmatched twins of v from the left set of its bidomain bd
+static void remove_twins(vector<int> &left, Bidomain &bd, const Graph &g0, int v) {
+    for (int i = 0; i < bd.left_len;) {
+        if (g0.twin_class[left[bd.l + i]] == g0.twin_class[v])
+            remove_vtx_from_array(left, bd.l, bd.left_len, i);
+        else
+            i++;
+    }
+}
+
 void remove_bidomain(vector<Bidomain> &domains, int idx) {
     domains[idx] = domains[domains.size() - 1];
     domains.pop_back();
 }
 
-void solve(const Graph &g0, const Graph &g1, Rewards &rewards,
-           vector<VtxPair> &incumbent,
-           vector<VtxPair> &current, vector<int> &g0_matched, vector<int> &g1_matched,
-           vector<Bidomain> &domains, vector<int> &left, vector<int> &right, unsigned int matching_size_goal,
-           Stats *stats) {
+/**
+ * In big_first and decision mode the search stops as soon as an incumbent of the target size is found
+ */
+bool goal_reached(const vector<VtxPair> &incumbent, unsigned int matching_size_goal) {
+    return (arguments.big_first || arguments.decision > 0) && incumbent.size() >= matching_size_goal;
+}
+
+unsigned int decision_goal(int n0, int n1) {
+    if (arguments.decision >= 1)
+        return (unsigned int) arguments.decision;
+    return (unsigned int) std::ceil(arguments.decision * std::max(n0, n1) - 1e-9);
+}
+
+/**
+ * Publish a new incumbent to the stream, if any. The global bound is the pre-search bound, or in big_first mode
+ * the current goal (all larger ones were refuted).
+ */
+static void publish_incumbent(const vector<VtxPair> &incumbent, unsigned int matching_size_goal, Stats *stats) {
+    if (stats->shared_best) {
+        unsigned int best = stats->shared_best->load();
+        while (incumbent.size() > best && !stats->shared_best->compare_exchange_weak(best, incumbent.size()));
+    }
+    if (!stats->incumbent_stream)
+        return;
+    int bound = arguments.big_first && matching_size_goal ? (int) matching_size_goal : stats->presearch_bound;
+    if (!stats->stream_vertices0) {
+        stats->incumbent_stream->write(incumbent, stats->nodes, bound);
+        return;
+    }
+    vector<VtxPair> mapped;
+    for (const VtxPair &pr: incumbent)
+        mapped.emplace_back((*stats->stream_vertices0)[pr.v], (*stats->stream_vertices1)[pr.w]);
+    stats->incumbent_stream->write(mapped, stats->nodes, bound);
+}
+
+/**
+ * Depth-first branch and bound over the explicit stack of s. Each frame goes through the steps of a call of the
+ * recursive formulation: the child of each v -> w assignment is a new frame, and the branch where v stays
+ * unmatched reuses the frame. When the search is interrupted (timeout, restart limit, goal reached) s is left
+ * as it is, so that it can be saved and continued.
+ */
+void solve(const Graph &g0, const Graph &g1, Rewards &rewards, vector<VtxPair> &incumbent, SearchState &s,
+           Stats *stats, CheckpointWriter *checkpoints) {
     // FIXME we have 2 timeout systems, remove one of them (the first seems to not work...)
     /*if (arguments.timeout && double(clock() - stats->start) / CLOCKS_PER_SEC > arguments.timeout) {
         return;
     }*/
-    if (stats->abort_due_to_timeout)
-        return;
-    stats->nodes++;
-    if (arguments.max_iter > 0 && stats->nodes > arguments.max_iter) {
-        cout << "max_iter" << endl;
-        return;
-    }
+    vector<SearchFrame> &stack = s.stack;
+    while (!stack.empty()) {
+        SearchFrame *f = &stack.back();
+        if (f->bd_idx == -1) { // entering a new node
+            if (stats->abort_due_to_timeout)
+                return;
+            if (stats->restart_node_limit && stats->nodes >= stats->restart_node_limit) {
+                stats->restart_limit_hit = true;
+                return;
+            }
+            if (checkpoints && checkpoints->due(stats->nodes))
+                checkpoints->save(s, incumbent, rewards, stats, false);
+            stats->nodes++;
+            if (arguments.max_iter > 0 && stats->nodes > arguments.max_iter) {
+                cout << "max_iter" << endl;
+                s.pop_frame();
+                continue;
+            }
 
-    if (current.size() > incumbent.size()) { // incumbent 现任的
-        incumbent = current;
-        stats->bestcount = stats->cutbranches + 1;
-        stats->bestnodes = stats->nodes;
-        if (!arguments.quiet)
-            cout << "Incumbent size: " << incumbent.size() << endl;
-        stats->bestfind = clock();
+            if (s.current.size() > incumbent.size()) { // incumbent 现任的
+                incumbent = s.current;
+                stats->bestcount = stats->cutbranches + 1;
+                stats->bestnodes = stats->nodes;
+                if (!arguments.quiet)
+                    cout << "Incumbent size: " << incumbent.size() << endl;
+                stats->bestfind = clock();
+                publish_incumbent(incumbent, s.goal, stats);
 
-        rewards.update_policy_counter(true);
-    }
+                rewards.update_policy_counter(true);
+            }
 
-    // prune branch if upper bound is too small
-    unsigned int bound = current.size() + calc_bound(domains);
-    if (bound <= incumbent.size() || bound < matching_size_goal) {
-        stats->cutbranches++;
-        // cout << "nodes: " << stats->nodes  << " pruned" << endl;
-        return;
-    }
-    // exit branch if goal already reached in big_first policy
-    if (arguments.big_first && incumbent.size() == matching_size_goal)
-        return;
+            // prune branch if upper bound is too small
+            unsigned int best = incumbent.size();
+            if (stats->shared_best)
+                best = std::max(best, stats->shared_best->load(std::memory_order_relaxed));
+            unsigned int bound = s.current.size() + calc_bound(f->domains);
+            // the connected bound costs a BFS, only compute it if the cheap one does not prune
+            if (arguments.connected && !s.current.empty() && bound > best && bound >= s.goal)
+                bound = s.current.size() + calc_connected_bound(f->domains, g0, g1, s);
+            if (bound <= best || bound < s.goal) {
+                stats->cutbranches++;
+                s.pop_frame();
+                continue;
+            }
+            // exit branch if goal already reached in big_first policy or decision mode
+            if (goal_reached(incumbent, s.goal))
+                return;
 
-    // select bidomain based on heuristic
-    int bd_idx = select_bidomain(domains, left, rewards, current.size());
-    if (bd_idx == -1) { // In the MCCS case, there may be nothing we can branch on
-        return;
-    }
-    Bidomain &bd = domains[bd_idx];
-
-    int v, w;
-    int tmp_idx;
-
-    // select vertex v (vertex with max reward)
-    if(arguments.random_start && incumbent.size() == 0) // First vertex can optionally be random
-        tmp_idx = rand() % bd.left_len;
-    else
-        tmp_idx = selectV_index(left, rewards, bd.l, bd.left_len);
-    v = left[bd.l + tmp_idx];
-    remove_vtx_from_array(left, bd.l, bd.left_len, tmp_idx); // remove v from bidomain
-    rewards.update_policy_counter(false);
-
-    // Try assigning v to each vertex w in the colour class beginning at bd.r, in turn
-    vector<int> wselected(g1.n, 0);
-    bd.right_len--; //
-    for (int i = 0; i <= bd.right_len; i++) {
-        tmp_idx = selectW_index(g0, g1, current, right, rewards, v, bd.r, bd.right_len + 1, wselected);
-        w = right[bd.r + tmp_idx];
-        wselected[w] = 1;
-        std::swap(right[bd.r + tmp_idx], right[bd.r + bd.right_len]);
-        rewards.update_policy_counter(false);
+            // select bidomain based on heuristic
+            int bd_idx = select_bidomain(f->domains, s.left, rewards, s.current.size());
+            if (bd_idx == -1) { // In the MCCS case, there may be nothing we can branch on
+                s.pop_frame();
+                continue;
+            }
+            Bidomain &bd = f->domains[bd_idx];
+
+            // select vertex v (vertex with max reward)
+            int tmp_idx;
+            if (arguments.random_start && incumbent.size() == 0) // First vertex can optionally be random
+                tmp_idx = rand() % bd.left_len;
+            else
+                tmp_idx = selectV_index(s.left, rewards, bd.l, bd.left_len);
+            f->v = s.left[bd.l + tmp_idx];
+            remove_vtx_from_array(s.left, bd.l, bd.left_len, tmp_idx); // remove v from bidomain
+            rewards.update_policy_counter(false);
+
+            f->bd_idx = bd_idx;
+            f->w_iter = 0;
+            f->wselected.assign(g1.n, 0);
+            bd.right_len--;
+        } else { // back from the child of the last v -> w assignment
+            if (stats->abort_due_to_timeout) // hard timeout (else it gets stuck when trying to end the program gracefully)
+                return;
+            if (stats->restart_limit_hit)
+                return;
+            if (goal_reached(incumbent, s.goal))
+                return;
+            while (s.current.size() > f->cur_len) {
+                VtxPair pr = s.current.back();
+                s.current.pop_back();
+                s.g0_matched[pr.v] = 0;
+                s.g1_matched[pr.w] = 0;
+            }
+            f->w_iter++;
+        }
+
+        // Try assigning v to each vertex w in the colour class beginning at bd.r, in turn
+        Bidomain &bd = f->domains[f->bd_idx];
+        int tmp_idx = -1; // -1 once every candidate (or twin class) has been tried
+        if (f->w_iter <= bd.right_len)
+            tmp_idx = selectW_index(g0, g1, s.current, s.right, rewards, f->v, bd.r, bd.right_len + 1,
+                                    f->wselected);
+        if (tmp_idx != -1) {
+            int w = s.right[bd.r + tmp_idx];
+            f->wselected[g1.twin_class[w]] = 1;
+            std::swap(s.right[bd.r + tmp_idx], s.right[bd.r + bd.right_len]);
+            rewards.update_policy_counter(false);
 #if (DEBUG)
-        if(stats->nodes % 100000 == 0)
-            std::cout << "nodes: " << stats->nodes << ", v: " << v << ", w: " << w << ", size: " << current.size() << ", dom: "<< bd.left_len << " " << bd.right_len << std::endl;
+            if(stats->nodes % 100000 == 0)
+                std::cout << "nodes: " << stats->nodes << ", v: " << f->v << ", w: " << w << ", size: " << s.current.size() << ", dom: "<< bd.left_len << " " << bd.right_len << std::endl;
 #endif
-        unsigned int cur_len = current.size();
-        auto result = generate_new_domains(domains, bd_idx, current, g0_matched, g1_matched, left, right, g0, g1,
-                                           v, w,
-                                           arguments.directed || arguments.edge_labelled, stats);
-        auto new_domains = result.new_domains;
-        rewards.update_rewards(result, v, w, stats);
-
-        stats->dl++;
-        solve(g0, g1, rewards, incumbent, current, g0_matched, g1_matched, new_domains, left, right,
-              matching_size_goal,
-              stats);
-        if (stats->abort_due_to_timeout) // hard timeout (else it gets stuck when trying to end the program gracefully)
-            return;
-        while (current.size() > cur_len) {
-            VtxPair pr = current.back();
-            current.pop_back();
-            g0_matched[pr.v] = 0;
-            g1_matched[pr.w] = 0;
+            f->cur_len = s.current.size();
+            auto result = generate_new_domains(f->domains, f->bd_idx, s.current, s.g0_matched, s.g1_matched,
+                                               s.left, s.right, g0, g1, f->v, w,
+                                               arguments.directed || arguments.edge_labelled, stats);
+            rewards.update_rewards(result, f->v, w, stats);
+
+            stats->dl++;
+            stack.emplace_back(std::move(result.new_domains)); // invalidates f
+            continue;
         }
+
+        // v stays unmatched, go on with the same node
+        bd.right_len++;
+        if (g0.twin_class_size[f->v] > 1) // a solution using a twin of v instead is symmetric to one using v
+            remove_twins(s.left, bd, g0, f->v);
+        if (bd.left_len == 0)
+            remove_bidomain(f->domains, f->bd_idx);
+        f->bd_idx = -1;
     }
-    bd.right_len++;
-    if (bd.left_len == 0)
-        remove_bidomain(domains, bd_idx);
-    solve(g0, g1, rewards, incumbent, current, g0_matched, g1_matched, domains, left, right, matching_size_goal,
-          stats);
 }
 
-vector<VtxPair> mcs(const Graph &g0, const Graph &g1, void *rewards_p, Stats *stats) {
-    vector<int> left;  // the buffer of vertex indices for the left partitions
-    vector<int> right; // the buffer of vertex indices for the right partitions
+// i-th element (from 1) of the Luby sequence 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+static unsigned long long luby(unsigned long long i) {
+    int k = 1;
+    while ((1ULL << k) - 1 < i)
+        k++;
+    if (i == (1ULL << k) - 1)
+        return 1ULL << (k - 1);
+    return luby(i - (1ULL << (k - 1)) + 1);
+}
 
-    vector<int> g0_matched(g0.n, 0);
-    vector<int> g1_matched(g1.n, 0);
+// node budget of the restart phase `phase` (from 0)
+static unsigned long long restart_budget(int phase) {
+    if (arguments.restart_policy == LUBY_RESTARTS)
+        return arguments.restart_base * luby(phase + 1);
+    return (unsigned long long) (arguments.restart_base * std::pow(geometric_restart_factor, phase));
+}
 
-    Rewards &rewards = *(Rewards *) rewards_p;
+static SearchState root_state(const Graph &g0, const Graph &g1, const vector<Bidomain> &domains,
+                              const vector<int> &left, const vector<int> &right, unsigned int matching_size_goal,
+                              int phase) {
+    SearchState s;
+    s.stack.reserve(std::min(g0.n, g1.n) + 1);
+    s.stack.emplace_back(domains);
+    s.left = left;
+    s.right = right;
+    s.g0_matched.assign(g0.n, 0);
+    s.g1_matched.assign(g1.n, 0);
+    s.goal = matching_size_goal;
+    s.phase = phase;
+    return s;
+}
 
-    auto domains = vector<Bidomain>{};
+/**
+ * Search the tree rooted at the given bidomains for matching_size_goal, or continue the search saved in resumed.
+ * With a restart policy, the search first runs arguments.max_restarts phases limited by a node budget, each one
+ * starting again from the root with the incumbent and the rewards learned so far. The last phase has no limit,
+ * so the search stays complete; it also stops early if a limited phase exhausts the tree.
+ */
+static void search(const Graph &g0, const Graph &g1, Rewards &rewards, vector<VtxPair> &incumbent,
+                   const vector<Bidomain> &domains, const vector<int> &left, const vector<int> &right,
+                   unsigned int matching_size_goal, Stats *stats, CheckpointWriter *checkpoints,
+                   Checkpoint *resumed) {
+    int limited_phases = arguments.restart_policy == NO_RESTARTS ? 0 : arguments.max_restarts;
+    for (int phase = resumed ? resumed->search.phase : 0; phase <= limited_phases; phase++) {
+        SearchState s;
+        if (resumed) {
+            s = std::move(resumed->search);
+            stats->restart_node_limit = resumed->restart_node_limit;
+            resumed = nullptr;
+        } else {
+            s = root_state(g0, g1, domains, left, right, matching_size_goal, phase);
+            stats->restart_node_limit = phase < limited_phases ? stats->nodes + restart_budget(phase) : 0;
+        }
+        stats->restart_limit_hit = false;
+        solve(g0, g1, rewards, incumbent, s, stats, checkpoints);
+        if (checkpoints && stats->abort_due_to_timeout) {
+            checkpoints->save(s, incumbent, rewards, stats, true);
+            if (!arguments.quiet)
+                cout << "Checkpoint saved after " << stats->nodes << " nodes" << endl;
+        }
+        stats->restart_node_limit = 0;
+        if (!stats->restart_limit_hit) // tree exhausted, goal reached or timeout
+            break;
+        stats->restarts++;
+        if (!arguments.quiet)
+            cout << "Restart " << stats->restarts << " after " << stats->nodes << " nodes, incumbent size "
+                 << incumbent.size() << endl;
+    }
+}
+
+/**
+ * big_first with several goals at once. Each worker takes the next goal in decreasing order and searches it with
+ * its own counters and its own copy of the rewards, which it keeps learning across the goals it takes.
+ * A success at k settles every goal <= k, a failure at k (MCS < k) every goal >= k, and the searches running on
+ * settled goals are cancelled. Once no goal is left above the best size found, the result is optimal.
+ */
+static void parallel_goal_descent(const Graph &g0, const Graph &g1, Rewards &rewards, vector<VtxPair> &incumbent,
+                                  const vector<Bidomain> &domains, const vector<int> &left,
+                                  const vector<int> &right, unsigned int top_goal, unsigned int min_goal,
+                                  Stats *stats) {
+    int threads = arguments.parallel_goals;
+    std::mutex mutex;
+    unsigned int next_goal = top_goal;
+    unsigned int smallest_failed = UINT_MAX;
+    vector<Stats *> running(threads, nullptr);
+    vector<unsigned int> running_goal(threads, 0);
+
+    auto cancel = [&](auto settled) {
+        for (int t = 0; t < threads; t++)
+            if (running[t] && settled(running_goal[t]))
+                running[t]->abort_due_to_timeout = true;
+    };
+
+    auto worker = [&](int t) {
+        DoubleQRewards local_rewards(dynamic_cast<const DoubleQRewards &>(rewards));
+        while (true) {
+            Stats local_stats;
+            local_stats.abort_due_to_timeout = false;
+            local_stats.presearch_bound = stats->presearch_bound;
+            local_stats.start = stats->start;
+            local_stats.incumbent_stream = stats->incumbent_stream; // nodes in its records are the worker's own
+            unsigned int goal;
+            vector<VtxPair> local_incumbent;
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                if (stats->abort_due_to_timeout || next_goal < min_goal || next_goal <= incumbent.size())
+                    break;
+                goal = next_goal--;
+                local_incumbent = incumbent;
+                running[t] = &local_stats;
+                running_goal[t] = goal;
+            }
 
+            stats->add_child(&local_stats); // the global timeout stops it too
+            search(g0, g1, local_rewards, local_incumbent, domains, left, right, goal, &local_stats, nullptr,
+                   nullptr);
+            stats->remove_child(&local_stats);
+
+            std::lock_guard<std::mutex> guard(mutex);
+            running[t] = nullptr;
+            stats->nodes += local_stats.nodes;
+            stats->cutbranches += local_stats.cutbranches;
+            stats->conflicts += local_stats.conflicts;
+            stats->restarts += local_stats.restarts;
+            if (local_incumbent.size() > incumbent.size()) {
+                incumbent = local_incumbent;
+                stats->bestnodes = stats->nodes;
+                stats->bestfind = clock();
+                publish_incumbent(incumbent, goal, stats);
+                if (!arguments.quiet)
+                    cout << "Incumbent size: " << incumbent.size() << " (goal " << goal << ")" << endl;
+            }
+            if (local_incumbent.size() >= goal) {
+                unsigned int found = incumbent.size();
+                cancel([found](unsigned int g) { return g <= found; });
+            } else if (!local_stats.abort_due_to_timeout) { // the whole tree was searched: MCS < goal
+                smallest_failed = std::min(smallest_failed, goal);
+                cancel([goal](unsigned int g) { return g >= goal; });
+                if (!arguments.quiet)
+                    cout << "Upper bound: " << smallest_failed - 1 << std::endl;
+            }
+        }
+    };
+
+    thread_pool().run_lanes(threads, worker);
+}
+
+// one bidomain per label that appears in both graphs
+static void initial_domains(const Graph &g0, const Graph &g1, vector<Bidomain> &domains, vector<int> &left,
+                            vector<int> &right) {
     std::set<unsigned int> left_labels;
     std::set<unsigned int> right_labels;
     for (auto node: g0.adjlist)
@@ -467,30 +756,291 @@ vector<VtxPair> mcs(const Graph &g0, const Graph &g1, void *rewards_p, Stats *st
         int right_len = right.size() - start_r;
         domains.push_back({start_l, start_r, left_len, right_len, false});
     }
+}
+
+// the rewards of the vertices of two components, renumbered as in their subgraphs
+static DoubleQRewards component_rewards(const DoubleQRewards &rewards, const vector<int> &vertices0,
+                                        const vector<int> &vertices1) {
+    DoubleQRewards local(vertices0.size(), vertices1.size());
+    for (unsigned int i = 0; i < vertices0.size(); i++) {
+        local.V[i] = rewards.V[vertices0[i]];
+        for (unsigned int j = 0; j < vertices1.size(); j++)
+            local.Q[i][j] = rewards.Q[vertices0[i]][vertices1[j]];
+    }
+    for (unsigned int j = 0; j < vertices1.size(); j++)
+        local.SingleQ[j] = rewards.SingleQ[vertices1[j]];
+    if (!rewards.left_initial_sort_order.empty()) {
+        for (unsigned int i = 0; i < vertices0.size(); i++)
+            local.left_initial_sort_order[i] = rewards.left_initial_sort_order[vertices0[i]];
+        local.right_initial_sort_order.assign(vertices1.size(), 0);
+        for (unsigned int j = 0; j < vertices1.size(); j++)
+            local.right_initial_sort_order[j] = rewards.right_initial_sort_order[vertices1[j]];
+    }
+    return local;
+}
+
+struct ComponentPair {
+    int c0, c1;
+    unsigned int bound;
+};
+
+/**
+ * Connected mode: the solution lies inside one connected component of each graph, so each pair of components
+ * (of two vertices or more) is solved on its own, and the best result wins. The pairs are taken by decreasing
+ * label bound by arguments.threads workers, each with its own counters and a restriction of the rewards. The
+ * searches share the best size found so far through stats->shared_best, so that each one prunes against the
+ * others' results; once the next pair's bound cannot beat it, the remaining pairs are skipped.
+ */
+static void solve_component_pairs(const Graph &g0, const Graph &g1, Rewards &rewards, vector<VtxPair> &incumbent,
+                                  const vector<vector<int>> &components0, const vector<vector<int>> &components1,
+                                  unsigned int min_goal, Stats *stats) {
+    auto subgraphs = [](const Graph &g, const vector<vector<int>> &components) {
+        vector<Graph> graphs;
+        for (auto &vertices: components) {
+            graphs.push_back(vertex_subgraph(g, vertices));
+            graphs.back().pack_leaves();
+            if (arguments.twins)
+                graphs.back().compute_twin_classes();
+        }
+        return graphs;
+    };
+    vector<Graph> graphs0 = subgraphs(g0, components0);
+    vector<Graph> graphs1 = subgraphs(g1, components1);
+
+    vector<label_count> labels1;
+    for (const Graph &g: graphs1)
+        labels1.push_back(count_labels(g));
+    vector<ComponentPair> pairs;
+    for (unsigned int i = 0; i < graphs0.size(); i++) {
+        label_count labels0 = count_labels(graphs0[i]);
+        for (unsigned int j = 0; j < graphs1.size(); j++) {
+            unsigned int bound = histogram_intersection(labels0, labels1[j]);
+            if (bound > incumbent.size() && bound >= min_goal)
+                pairs.push_back({(int) i, (int) j, bound});
+        }
+    }
+    std::stable_sort(pairs.begin(), pairs.end(),
+                     [](const ComponentPair &a, const ComponentPair &b) { return a.bound > b.bound; });
+    if (!arguments.quiet)
+        cout << "Connected components: " << graphs0.size() << " x " << graphs1.size() << ", " << pairs.size()
+             << " pairs to search" << endl;
+
+    const auto &global_rewards = dynamic_cast<const DoubleQRewards &>(rewards);
+    std::atomic<unsigned int> best(incumbent.size());
+    std::mutex mutex;
+    unsigned int next_pair = 0;
+    int threads = std::max(1, std::min(arguments.threads, (int) pairs.size()));
+
+    auto worker = [&](int) {
+        while (true) {
+            ComponentPair pair;
+            Stats local_stats;
+            local_stats.abort_due_to_timeout = false;
+            local_stats.start = stats->start;
+            local_stats.shared_best = &best;
+            // the stream gets the incumbents of the pair as they are found, in the indices of g0 and g1
+            local_stats.incumbent_stream = stats->incumbent_stream;
+            local_stats.presearch_bound = stats->presearch_bound;
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                if (stats->abort_due_to_timeout || next_pair == pairs.size() ||
+                    pairs[next_pair].bound <= best.load() || (arguments.decision > 0 && best.load() >= min_goal))
+                    break;
+                pair = pairs[next_pair++];
+            }
+
+            const Graph &c0 = graphs0[pair.c0], &c1 = graphs1[pair.c1];
+            local_stats.stream_vertices0 = &components0[pair.c0];
+            local_stats.stream_vertices1 = &components1[pair.c1];
+            DoubleQRewards local_rewards = component_rewards(global_rewards, components0[pair.c0],
+                                                             components1[pair.c1]);
+            vector<int> left, right;
+            vector<Bidomain> domains;
+            initial_domains(c0, c1, domains, left, right);
+            vector<VtxPair> local_incumbent;
+            stats->add_child(&local_stats); // the global timeout stops it too
+            if (arguments.big_first) {
+                for (unsigned int goal = pair.bound; goal > best.load() && goal >= min_goal; goal--) {
+                    search(c0, c1, local_rewards, local_incumbent, domains, left, right, goal, &local_stats,
+                           nullptr, nullptr);
+                    if (local_incumbent.size() >= goal || local_stats.abort_due_to_timeout)
+                        break;
+                }
+            } else {
+                search(c0, c1, local_rewards, local_incumbent, domains, left, right, min_goal, &local_stats,
+                       nullptr, nullptr);
+            }
+            stats->remove_child(&local_stats);
+
+            std::lock_guard<std::mutex> guard(mutex);
+            stats->nodes += local_stats.nodes;
+            stats->cutbranches += local_stats.cutbranches;
+            stats->conflicts += local_stats.conflicts;
+            stats->restarts += local_stats.restarts;
+            if (local_incumbent.size() > incumbent.size()) {
+                incumbent.clear();
+                for (auto &pr: local_incumbent)
+                    incumbent.emplace_back(components0[pair.c0][pr.v], components1[pair.c1][pr.w]);
+                stats->bestnodes = stats->nodes;
+                stats->bestfind = clock();
+                publish_incumbent(incumbent, 0, stats);
+                if (!arguments.quiet)
+                    cout << "Incumbent size: " << incumbent.size() << " (components " << pair.c0 << ", "
+                         << pair.c1 << ")" << endl;
+            }
+        }
+    };
+
+    thread_pool().run_lanes(threads, worker);
+}
+
+vector<VtxPair> mcs(const Graph &g0, const Graph &g1, void *rewards_p, Stats *stats) {
+    // in decision mode nothing smaller than the threshold is of interest
+    unsigned int min_goal = arguments.decision > 0 ? std::max(1u, decision_goal(g0.n, g1.n)) : 1;
+
+    // cheap bounds can settle the instance before any bidomain is built
+    PreSearchBounds pre = presearch_bounds(g0, g1, arguments.connected);
+    stats->presearch_bound = pre.upper;
+    if (!arguments.quiet)
+        cout << "Pre-search bounds: labels " << pre.label_bound << ", components " << pre.component_bound
+             << ", trivial solution " << pre.trivial.size() << endl;
+    if (pre.settled() || (arguments.decision > 0 && pre.trivial.size() >= min_goal)) {
+        stats->presearch_settled = true;
+        if (!pre.trivial.empty())
+            publish_incumbent(pre.trivial, 0, stats);
+        return pre.trivial;
+    }
+    if (arguments.decision > 0 && (unsigned int) pre.upper < min_goal) {
+        if (!arguments.quiet)
+            cout << "Pre-search bound " << pre.upper << " is below the decision threshold " << min_goal << endl;
+        stats->presearch_settled = true;
+        if (!pre.trivial.empty())
+            publish_incumbent(pre.trivial, 0, stats);
+        return pre.trivial;
+    }
+
+    vector<int> left;  // the buffer of vertex indices for the left partitions
+    vector<int> right; // the buffer of vertex indices for the right partitions
+
+    Rewards &rewards = *(Rewards *) rewards_p;
+
+    auto domains = vector<Bidomain>{};
+    initial_domains(g0, g1, domains, left, right);
 
     vector<VtxPair> incumbent;
 
-    if (arguments.big_first) {
+    // with the same graphs and options, a checkpoint continues the search exactly where it stopped
+    std::unique_ptr<CheckpointWriter> checkpoints;
+    if (arguments.checkpoint)
+        checkpoints = std::make_unique<CheckpointWriter>(arguments.checkpoint, arguments.checkpoint_interval, g0, g1);
+    Checkpoint resumed;
+    bool resuming = false;
+    if (arguments.resume) {
+        resuming = read_checkpoint(arguments.resume, graph_pair_fingerprint(g0, g1), resumed);
+        if (!resuming) {
+            if (!arguments.quiet)
+                cout << "No checkpoint " << arguments.resume << ", starting from scratch" << endl;
+        } else if (!arguments.big_first && resumed.search.goal != min_goal) {
+            cerr << "Checkpoint " << arguments.resume << " was taken with a different goal" << endl;
+            exit(1);
+        } else {
+            restore_checkpoint(resumed, rewards, stats);
+            incumbent = resumed.incumbent;
+            stats->bestfind = clock();
+            if (!arguments.quiet)
+                cout << "Resuming after " << stats->nodes << " nodes, incumbent size " << incumbent.size() << endl;
+            if (!incumbent.empty())
+                publish_incumbent(incumbent, resumed.search.goal, stats);
+        }
+    }
+    if (checkpoints)
+        checkpoints->prepare(rewards);
+
+    // induced subgraph isomorphism fast path: the first big_first goal, or the question asked by --pattern
+    unsigned int smaller_n = std::min(g0.n, g1.n);
+    bool embedding_refuted = false;
+    if ((arguments.big_first || arguments.pattern) && !resuming && (unsigned int) pre.upper == smaller_n &&
+        smaller_n >= min_goal) {
+        bool pattern_is_g0 = g0.n <= g1.n;
+        const Graph &pattern = pattern_is_g0 ? g0 : g1;
+        if (!arguments.connected || is_connected(pattern)) {
+            vector<VtxPair> embedding;
+            SIResult si = induced_subgraph_isomorphism(pattern, pattern_is_g0 ? g1 : g0, embedding, stats);
+            if (si == SI_ABORTED)
+                return pre.trivial;
+            if (si == SI_FOUND) {
+                if (!pattern_is_g0)
+                    for (auto &pr: embedding)
+                        std::swap(pr.v, pr.w);
+                stats->bestnodes = stats->nodes;
+                stats->bestfind = clock();
+                publish_incumbent(embedding, smaller_n, stats);
+                if (!arguments.quiet)
+                    cout << "Induced subgraph isomorphism found" << endl;
+                return embedding;
+            }
+            embedding_refuted = true;
+            if (!arguments.quiet)
+                cout << "No induced subgraph isomorphism, upper bound: " << smaller_n - 1 << endl;
+        }
+    }
+
+    // a real solution from the heuristic lets the bound prune from the first node
+    if (arguments.warm_start > 0 && !resuming) {
+        double budget = arguments.warm_start * (arguments.timeout ? arguments.timeout : 1);
+        incumbent = warm_start(g0, g1, rewards, domains, left, right, budget, pre.upper, stats);
+        if (pre.trivial.size() > incumbent.size())
+            incumbent = pre.trivial;
+        stats->bestfind = clock();
+        if (!incumbent.empty())
+            publish_incumbent(incumbent, 0, stats);
+        if (incumbent.size() >= (unsigned int) pre.upper)
+            return incumbent;
+    }
+
+    // connected mode on disconnected graphs: one search per pair of components
+    if (arguments.connected) {
+        auto components0 = connected_components(g0, 2);
+        auto components1 = connected_components(g1, 2);
+        if ((components0.size() > 1 || components1.size() > 1) && checkpoints) {
+            // a checkpoint holds the state of a single search
+            cerr << "Connected components are not searched pair by pair when checkpointing" << endl;
+        } else if (components0.size() > 1 || components1.size() > 1) {
+            if (pre.trivial.size() > incumbent.size())
+                incumbent = pre.trivial;
+            solve_component_pairs(g0, g1, rewards, incumbent, components0, components1, min_goal, stats);
+            return incumbent;
+        }
+    }
+
+    if (arguments.big_first && arguments.parallel_goals > 1) {
+        unsigned int top_goal = std::min(g0.n, pre.upper) - (embedding_refuted ? 1 : 0);
+        parallel_goal_descent(g0, g1, rewards, incumbent, domains, left, right, top_goal, min_goal, stats);
+    } else if (arguments.big_first) {
         for (int k = 0; k < g0.n; k++) {
             unsigned int goal = g0.n - k;
-            auto left_copy = left;
-            auto right_copy = right;
-            auto domains_copy = domains;
-            vector<VtxPair> current;
-            solve(g0, g1, rewards, incumbent, current, g0_matched, g1_matched, domains_copy, left_copy, right_copy,
-                  goal,
-                  stats);
-            if (incumbent.size() == goal || stats->abort_due_to_timeout)
+            if (goal > (unsigned int) pre.upper) // hopeless goals
+                continue;
+            if (embedding_refuted && goal >= smaller_n)
+                continue;
+            if (goal < min_goal)
+                break;
+            if (resuming && goal > resumed.search.goal) // already searched before the checkpoint
+                continue;
+            search(g0, g1, rewards, incumbent, domains, left, right, goal, stats, checkpoints.get(),
+                   resuming ? &resumed : nullptr);
+            resuming = false;
+            if (incumbent.size() >= goal || stats->abort_due_to_timeout)
                 break;
             if (!arguments.quiet)
                 cout << "Upper bound: " << goal - 1 << std::endl;
         }
     } else {
-        vector<VtxPair> current;
-        solve(g0, g1, rewards, incumbent, current, g0_matched, g1_matched, domains, left, right, 1, stats);
+        search(g0, g1, rewards, incumbent, domains, left, right, min_goal, stats, checkpoints.get(),
+               resuming ? &resumed : nullptr);
     }
 
-    if (arguments.timeout && double(clock() - stats->start) / CLOCKS_PER_SEC > arguments.timeout) {
+    if (!arguments.quiet && arguments.timeout && double(clock() - stats->start) / CLOCKS_PER_SEC > arguments.timeout) {
         cout << "time out" << endl;
     }
 
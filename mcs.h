@@ -34,6 +34,82 @@ struct NewBidomainResult{
     int reward;
 };
 
+/**
+ * A node of the explicit search stack. A frame is pushed for the child of each v -> w assignment and reused
+ * for the branch where v stays unmatched (the tail call of the recursive formulation).
+ */
+struct SearchFrame
+{
+    vector<Bidomain> domains;
+    int bd_idx = -1;          // bidomain being branched on, -1 until the node is expanded
+    int v = -1;               // vertex of g0 being matched
+    int w_iter = 0;           // iteration of the loop over the candidates w
+    unsigned int cur_len = 0; // size of the matching before the current child
+    vector<int> wselected;    // candidates w already tried
+
+    explicit SearchFrame(vector<Bidomain> domains) : domains(std::move(domains)) {}
+};
+
+/**
+ * Everything the search needs to go on from where it stopped: the stack, the vertex buffers (the order of their
+ * contents is part of the state) and the current matching
+ */
+struct SearchState
+{
+    vector<SearchFrame> stack;
+    vector<int> left;
+    vector<int> right;
+    vector<VtxPair> current;
+    vector<int> g0_matched;
+    vector<int> g1_matched;
+    unsigned int goal = 0; // matching size goal
+    int phase = 0;         // restart phase
+    // bottom frames of the stack left as they were at the last checkpoint snapshot of this state: a frame only
+    // changes while it is on top
+    size_t unchanged_frames = 0;
+
+    void pop_frame() {
+        stack.pop_back();
+        if (unchanged_frames >= stack.size())
+            unchanged_frames = stack.empty() ? 0 : stack.size() - 1;
+    }
+
+    // scratch space of calc_connected_bound(), not part of the saved state
+    vector<int> left_bd, right_bd;
+    vector<int> queue, reachable;
+};
+
+struct Rewards;
+
+// search kernels, shared with the warm start heuristic and bench/bench_kernels.cpp
+int calc_bound(const vector<Bidomain> &domains);
+
+int calc_connected_bound(const vector<Bidomain> &domains, const Graph &g0, const Graph &g1, SearchState &s);
+
+int selectV_index(const vector<int> &arr, const Rewards &rewards, int start_idx, int len);
+
+int selectW_index(const Graph &g0, const Graph &g1, const vector<VtxPair> &current, const vector<int> &arr,
+                  const Rewards &rewards, const int v, int start_idx, int len,
+                  const vector<int> &wselected);
+
+int select_bidomain(const vector<Bidomain> &domains, const vector<int> &left, const Rewards &rewards,
+                    int current_matching_size);
+
+// moves the neighbours of index in g to the front of all_vv[start, start + len), returns their number
+int partition(vector<int> &all_vv, int start, int len, const Graph &g, int index);
+
+void remove_vtx_from_array(vector<int> &arr, int start_idx, int &len, int remove_idx);
+
+NewBidomainResult
+generate_new_domains(const vector<Bidomain> &d, int bd_idx, vector<VtxPair> &current, vector<int> &g0_matched,
+                     vector<int> &g1_matched,
+                     vector<int> &left, vector<int> &right,
+                     const Graph &g0, const Graph &g1, int v, int w,
+                     bool multiway, Stats *stats);
+
 vector<VtxPair> mcs(const Graph &g0, const Graph &g1, void *rewards_p, Stats *stats);
 
+// minimum solution size asked by the decision mode (arguments.decision) for graphs of n0 and n1 vertices
+unsigned int decision_goal(int n0, int n1);
+
 #endif
\ No newline at end of file
@@ -19,7 +19,7 @@ static void fail(std::string msg) {
                              Command-line arguments
 *******************************************************************************/
 
-static char doc[] = "Find a maximum clique in a graph in DIMACS format\vHEURISTIC can be min_max or min_product or rewards_based or heuristic_based";
+static char doc[] = "Find a maximum clique in a graph in DIMACS format\vHEURISTIC can be min_max or min_product or rewards_based or heuristic_based. With --batch, FILENAME2 is a manifest of target graphs; with --all-pairs, FILENAME1 is a manifest and FILENAME2 is omitted";
 static char args_doc[] = "HEURISTIC FILENAME1 FILENAME2";
 static struct argp_option options[] = {
         {"quiet",                'q', 0,                   0, "Quiet output"},
@@ -32,10 +32,29 @@ static struct argp_option options[] = {
         {"labelled",             'a', 0,                   0, "Use edge and vertex labels"},
         {"vertex-labelled-only", 'x', 0,                   0, "Use vertex labels, but not edge labels"},
         {"big-first",            'b', 0,                   0, "First try to find an induced subgraph isomorphism, then decrement the target size"},
+        {"pattern",              'p', 0,                   0, "Pattern containment: first look for the smaller graph as an induced subgraph of the larger one (also done for the first goal of -b)"},
         {"timeout",              't', "timeout",           0, "Specify a timeout (seconds)"},
         {"random_start",         'r', 0,                   0, "Set random start to true"},
         {"dal_reward_policy",    'D', "dal_reward_policy", 0, "Specify the dal reward policy (num, max, avg)"},
-        {"sort_heuristic",       's', "sort_heuristic",    0, "Specify the sort heuristic (degree, pagerank, betweenness, closeness, clustering, katz)"},
+        {"sort_heuristic",       's', "sort_heuristic",    0, "Specify the sort heuristic (degree, pagerank, betweenness, closeness, clustering, katz, kcore, twohop, coredegree); betweenness and closeness take :approx=EPSILON or :samples=K to only use a sample of the source vertices"},
+        {"decision",             'k', "threshold",         0, "Decision mode: only decide whether MCS >= threshold (threshold >= 1), or whether |MCS| / max(|g0|, |g1|) >= threshold (0 < threshold < 1)"},
+        {"warm-start",           'w', "fraction",          0, "Seed the search with a greedy/local search solution, computed for this fraction of the timeout (of one second without -t)"},
+        {"twins",                'y', 0,                   0, "Symmetry pruning: branch on one vertex per class of twins (same label and neighbourhood)"},
+        {"no-complement",        'z', 0,                   0, "Do not solve on the complement graphs when both have density above 0.5 (never done with -c, -i or -a)"},
+        {"parallel-goals",       'g', "threads",           0, "With -b, search this many goals at once, at most as many as the threads of -T (default 1: one after the other)"},
+        {"restarts",             'R', "policy",            0, "Restart the search from the root every few nodes, keeping the learned rewards (luby, geometric)"},
+        {"restart-base",         'n', "nodes",             0, "Node budget of the first restart phase (default 1000)"},
+        {"max-restarts",         'm', "restarts",          0, "Number of restarts before the final, unlimited search (default 30)"},
+        {"checkpoint",           'C', "file",              0, "Save the search state to this file periodically and on timeout"},
+        {"checkpoint-interval",  'I', "seconds",           0, "Seconds between two checkpoints (default 60)"},
+        {"resume",               'U', "file",              0, "Continue the search saved in this checkpoint (from scratch if it does not exist); also checkpoints to it unless --checkpoint is given"},
+        {"score-cache",          'S', "directory",         0, "Keep the sort heuristic scores of each graph in this directory and reuse them in later runs"},
+        {"incumbents",           'j', "output",            0, "Write each new incumbent as a JSON line to this file, named pipe, fd:N or - (stdout)"},
+        {"batch",                'B', 0,                   0, "One-vs-many mode: FILENAME2 is a manifest listing one target graph per line"},
+        {"all-pairs",            'P', 0,                   0, "Many-vs-many mode: FILENAME1 is a manifest of graphs, compute the matrix of all pairwise solution sizes"},
+        {"threads",              'T', "threads",           0, "Size of the thread pool shared by the sort heuristics, the preprocessing, the batch modes and the component pairs of -c (default: hardware concurrency)"},
+        {"pin-threads",          'L', 0,                   0, "Bind each thread of the pool to its own CPU"},
+        {"output",               'o', "output",            0, "Output file for the batch mode records or matrix (default: stdout)"},
         {0}};
 
 void set_default_arguments() {
@@ -49,12 +68,31 @@ void set_default_arguments() {
     arguments.edge_labelled = false;
     arguments.vertex_labelled = false;
     arguments.big_first = false;
+    arguments.pattern = false;
     arguments.filename1 = NULL;
     arguments.filename2 = NULL;
     arguments.timeout = 0;
     arguments.max_iter = -1;
+    arguments.decision = 0;
+    arguments.warm_start = 0;
+    arguments.twins = false;
+    arguments.complement = true;
+    arguments.parallel_goals = 1;
+    arguments.restart_policy = NO_RESTARTS;
+    arguments.restart_base = 1000;
+    arguments.max_restarts = 30;
+    arguments.checkpoint = NULL;
+    arguments.checkpoint_interval = 60;
+    arguments.resume = NULL;
+    arguments.incumbents = NULL;
+    arguments.score_cache = NULL;
     arguments.random_start = false;
     arguments.arg_num = 0;
+    arguments.batch = false;
+    arguments.all_pairs = false;
+    arguments.threads = std::max(1u, std::thread::hardware_concurrency());
+    arguments.pin_threads = false;
+    arguments.output = NULL;
     arguments.sort_heuristic = new SortHeuristic::Degree();
     arguments.initialize_rewards = false; // if false, rewards are initialized to 0, else to sort_heuristic
     arguments.mcs_method = RL_DAL;
@@ -66,6 +104,54 @@ void set_default_arguments() {
     arguments.reward_policy.neighbor_overlap = NO_OVERLAP;    // use neighbor overlap to select W
 }
 
+/**
+ * NAME or NAME:approx=EPSILON or NAME:samples=K, the last two for the heuristics computed per source vertex
+ * (betweenness, closeness)
+ */
+static SortHeuristic::Base *parse_sort_heuristic(const string &spec) {
+    string name = spec.substr(0, spec.find(':'));
+    string option = spec.size() > name.size() ? spec.substr(name.size() + 1) : "";
+    SortHeuristic::Parallel *per_source = nullptr;
+    SortHeuristic::Base *heuristic;
+    if (name == "degree")
+        heuristic = new SortHeuristic::Degree();
+    else if (name == "pagerank")
+        heuristic = new SortHeuristic::PageRank();
+    else if (name == "betweenness")
+        heuristic = per_source = new SortHeuristic::BetweennessCentrality();
+    else if (name == "closeness")
+        heuristic = per_source = new SortHeuristic::ClosenessCentrality();
+    else if (name == "clustering")
+        heuristic = new SortHeuristic::LocalClusteringCoefficient();
+    else if (name == "katz")
+        heuristic = new SortHeuristic::KatzCentrality();
+    else if (name == "kcore")
+        heuristic = new SortHeuristic::CoreNumber();
+    else if (name == "twohop")
+        heuristic = new SortHeuristic::TwoHopDegree();
+    else if (name == "coredegree")
+        heuristic = new SortHeuristic::CoreThenDegree();
+    else
+        fail("Unknown sort heuristic (try degree, pagerank, betweenness, closeness, clustering, katz, kcore, twohop, coredegree)");
+    if (option.empty())
+        return heuristic;
+    if (!per_source)
+        fail("Only the betweenness and closeness sort heuristics can be approximated");
+    if (option.rfind("approx=", 0) == 0) {
+        double epsilon = std::atof(option.c_str() + 7);
+        if (epsilon <= 0 || epsilon >= 1)
+            fail("The approximation error must be between 0 and 1");
+        per_source->set_approximation(epsilon);
+    } else if (option.rfind("samples=", 0) == 0) {
+        int samples = std::atoi(option.c_str() + 8);
+        if (samples < 1)
+            fail("The number of samples must be positive");
+        per_source->set_samples(samples);
+    } else
+        fail("Unknown sort heuristic option (try approx=EPSILON or samples=K)");
+    return heuristic;
+}
+
 static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     switch (key) {
         case 'd':
@@ -112,12 +198,99 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
         case 'b':
             arguments.big_first = true;
             break;
+        case 'p':
+            arguments.pattern = true;
+            break;
         case 't':
             arguments.timeout = std::stoi(arg);
             break;
         case 'r':
             arguments.random_start = true;
             break;
+        case 'k': {
+            char *end;
+            arguments.decision = strtod(arg, &end);
+            if (end == arg || *end != '\0')
+                fail("The decision threshold must be a number");
+            if (arguments.decision <= 0)
+                fail("The decision threshold must be positive");
+            // from 1 up it is a number of vertices
+            if (arguments.decision >= 1 && arguments.decision != std::floor(arguments.decision))
+                fail("A decision threshold of at least 1 must be a whole number of vertices");
+            break;
+        }
+        case 'w':
+            arguments.warm_start = std::stod(arg);
+            if (arguments.warm_start < 0 || arguments.warm_start > 1)
+                fail("The warm start fraction must be between 0 and 1");
+            break;
+        case 'y':
+            arguments.twins = true;
+            break;
+        case 'z':
+            arguments.complement = false;
+            break;
+        case 'g':
+            arguments.parallel_goals = std::stoi(arg);
+            if (arguments.parallel_goals < 1)
+                fail("The number of parallel goals must be positive");
+            break;
+        case 'R':
+            if (string(arg) == "luby")
+                arguments.restart_policy = LUBY_RESTARTS;
+            else if (string(arg) == "geometric")
+                arguments.restart_policy = GEOMETRIC_RESTARTS;
+            else if (string(arg) == "none")
+                arguments.restart_policy = NO_RESTARTS;
+            else
+                fail("Unknown restart policy (try luby, geometric, none)");
+            break;
+        case 'n':
+            arguments.restart_base = std::stoull(arg);
+            if (arguments.restart_base == 0)
+                fail("The restart node budget must be positive");
+            break;
+        case 'm':
+            arguments.max_restarts = std::stoi(arg);
+            break;
+        case 'C':
+            arguments.checkpoint = arg;
+            break;
+        case 'I':
+            arguments.checkpoint_interval = std::stoi(arg);
+            if (arguments.checkpoint_interval <= 0)
+                fail("The checkpoint interval must be positive");
+            break;
+        case 'U':
+            arguments.resume = arg;
+            break;
+        case 'S':
+            arguments.score_cache = arg;
+            break;
+        case 'j':
+            arguments.incumbents = arg;
+            break;
+        case 'B':
+            if (arguments.all_pairs)
+                fail("The -B and -P options can't be used together.");
+            arguments.batch = true;
+            break;
+        case 'P':
+            if (arguments.batch)
+                fail("The -B and -P options can't be used together.");
+            arguments.all_pairs = true;
+            break;
+        case 'T':
+            arguments.threads = std::stoi(arg);
+            if (arguments.threads < 1)
+                fail("The number of threads must be at least 1");
+            break;
+        case 'L':
+            arguments.pin_threads = true;
+            break;
+        case 'o':
+            arguments.output = arg;
+            break;
         case 'D':
             if (string(arg) == "num")
                 arguments.reward_policy.dal_reward_policy = DAL_REWARD_MAX_NUM_DOMAINS;
@@ -129,20 +302,7 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
                 fail("Unknown dal reward policy (try num, max, avg)");
             break;
         case 's':
-            if (string(arg) == "degree")
-                arguments.sort_heuristic = new SortHeuristic::Degree();
-            else if (string(arg) == "pagerank")
-                arguments.sort_heuristic = new SortHeuristic::PageRank();
-            else if (string(arg) == "betweenness")
-                arguments.sort_heuristic = new SortHeuristic::BetweennessCentrality();
-            else if (string(arg) == "closeness")
-                arguments.sort_heuristic = new SortHeuristic::ClosenessCentrality();
-            else if (string(arg) == "clustering")
-                arguments.sort_heuristic = new SortHeuristic::LocalClusteringCoefficient();
-            else if (string(arg) == "katz")
-                arguments.sort_heuristic = new SortHeuristic::KatzCentrality();
-            else
-                fail("Unknown sort heuristic (try degree, pagerank, betweenness, closeness, clustering, katz)");
+            arguments.sort_heuristic = parse_sort_heuristic(arg);
             break;
         case ARGP_KEY_ARG:
             if (arguments.arg_num == 0) {
@@ -181,197 +341,92 @@ static struct argp argp = {options, parse_opt, args_doc, doc};
                                  Main
 *******************************************************************************/
 
-bool check_sol(const Graph &g0, const Graph &g1, const vector<VtxPair> &solution) {
-    vector<bool> used_left(g0.n, false);
-    vector<bool> used_right(g1.n, false);
-    for (unsigned int i = 0; i < solution.size(); i++)
-    {
-        struct VtxPair p0 = solution[i];
-        if (used_left[p0.v] || used_right[p0.w])
-        {
-            cout << "Used left: " << used_left[p0.v] << endl;
-            cout << "Used right: " << used_right[p0.w] << endl;
-            return false;
-        }
-        used_left[p0.v] = true;
-        used_right[p0.w] = true;
-        if (g0.adjlist[p0.v].label != g1.adjlist[p0.w].label)
-        {
-            cout << g0.adjlist[p0.v].label << " != " << g1.adjlist[p0.w].label << endl;
-            return false;
-        }
-        for (unsigned int j = i + 1; j < solution.size(); j++)
-        {
-            struct VtxPair p1 = solution[j];
-            if (g0.get(p0.v, p1.v) != g1.get(p0.w, p1.w))
-            {
-                cout << "Edge left (" << p0.v << " -> " << p1.v << ") = " << g0.get(p0.v, p1.v) << endl;
-                cout << "Edge right (" << p0.w << " -> " << p1.w << ") = " << g1.get(p0.w, p1.w) << endl;
-                return false;
-            }
-        }
-    }
-    return true;
-}
-
 int sum(const vector<int> &vec) {
     return std::accumulate(std::begin(vec), std::end(vec), 0);
 }
 
-/**
- * based on arguments.swap_policy, return true if the graphs needs to be swapped.
- * McSPLIT_SD and McSPLIT_SO are based on Trimble's PHD thesis https://theses.gla.ac.uk/83350/
- */
-bool swap_graphs(Graph g0, Graph g1) {
-    switch (arguments.swap_policy) {
-        case McSPLIT_SD: { // swap if density extremeness of g1 is bigger than that of g0
-            // get densities
-            float d0 = g0.computeDensity();
-            float d1 = g1.computeDensity();
-            // compute density extremeness
-            double de0 = abs(0.5 - d0);
-            double de1 = abs(0.5 - d1);
-            return de1 > de0;
-        }
-        case McSPLIT_SO:
-            return g1.n > g0.n;
-        default:
-            cerr << "swap policy unknown" << endl;
-        case NO_SWAP:
-            return false;
-    }
-}
-
 int main(int argc, char **argv) {
     set_default_arguments();
     argp_parse(&argp, argc, argv, 0, 0, 0);
 
-    char format = arguments.dimacs ? 'D' : arguments.lad ? 'L'
-                                                         : arguments.ascii ? 'A'
-                                                                           : 'B';
-    struct Graph g0 = readGraph(arguments.filename1, format, arguments.directed,
-                                arguments.edge_labelled, arguments.vertex_labelled);
-    struct Graph g1 = readGraph(arguments.filename2, format, arguments.directed,
-                                arguments.edge_labelled, arguments.vertex_labelled);
+    if ((arguments.batch || arguments.all_pairs) && (arguments.checkpoint || arguments.resume))
+        fail("Checkpoints are only supported for a single pair of graphs");
+    if ((arguments.batch || arguments.all_pairs) && arguments.incumbents)
+        fail("The incumbent stream is only supported for a single pair of graphs");
+    if (arguments.parallel_goals > arguments.threads)
+        fail("The number of parallel goals (-g) cannot exceed the number of threads (-T)");
+    if (arguments.parallel_goals > 1 && (arguments.checkpoint || arguments.resume))
+        fail("Checkpoints are not supported with parallel goals");
+    if (arguments.resume && !arguments.checkpoint)
+        arguments.checkpoint = arguments.resume;
+    init_thread_pool(arguments.threads, arguments.pin_threads);
+    arguments.sort_heuristic->set_num_threads(arguments.threads);
+
+    if (arguments.batch) {
+        arguments.quiet = true;
+        run_one_vs_many(arguments.filename1, arguments.filename2, arguments.output ? arguments.output : "-");
+        return 0;
+    }
+    if (arguments.all_pairs) {
+        arguments.quiet = true;
+        run_all_pairs(arguments.filename1, arguments.output ? arguments.output : "-");
+        return 0;
+    }
 
-    arguments.reward_policy.reward_switch_policy_threshold = 2 * std::min(g0.n, g1.n);
+    struct Graph g0 = read_input_graph(arguments.filename1);
+    struct Graph g1 = read_input_graph(arguments.filename2);
+    if (use_complements(g0, g1)) {
+        g0 = complement(g0);
+        g1 = complement(g1);
+        cout << "Solving on the complement graphs" << endl;
+    }
 
     Stats stats_s;
     Stats *stats = &stats_s;
-    std::thread timeout_thread;
-    std::mutex timeout_mutex;
-    std::condition_variable timeout_cv;
     stats->abort_due_to_timeout.store(false);
-
-    bool aborted = false;
-#if 1
-    if (0 != arguments.timeout) {
-        timeout_thread = std::thread([&] {
-            auto abort_time = std::chrono::steady_clock::now() + std::chrono::seconds(arguments.timeout);
-            {
-                /* Sleep until either we've reached the time limit,
-                 * or we've finished all the work. */
-                std::unique_lock<std::mutex> guard(timeout_mutex);
-                while (!stats->abort_due_to_timeout.load()) {
-                    if (std::cv_status::timeout == timeout_cv.wait_until(guard, abort_time)) {
-                        /* We've woken up, and it's due to a timeout. */
-                        aborted = true;
-                        break;
-                    }
-                }
-            }
-            stats->abort_due_to_timeout.store(true);
-        });
-    }
-#endif
-
-    // decide whether to swap the graphs based on swap_policy
-    if (swap_graphs(g0, g1)) {
-        swap(g0, g1);
-        stats->swapped_graphs = true;
-        cout << "Swapped graphs" << endl;
+    TimeoutWatcher timeout_watcher(stats, arguments.timeout);
+    std::unique_ptr<IncumbentStream> incumbent_stream;
+    if (arguments.incumbents) {
+        incumbent_stream = std::make_unique<IncumbentStream>(arguments.incumbents);
+        stats->incumbent_stream = incumbent_stream.get();
     }
 
     //  auto start = std::chrono::steady_clock::now();
     stats->start = clock();
 
     // static sort order
-    arguments.sort_heuristic->set_num_threads(10);
-    std::vector<int> g0_deg = arguments.sort_heuristic->sort(g0);
-    std::vector<int> g1_deg = arguments.sort_heuristic->sort(g1);
-
-    // As implemented here, g1_dense and g0_dense are false for all instances
-    // in the Experimental Evaluation section of the paper.  Thus,
-    // we always sort the vertices in descending order of degree (or total degree,
-    // in the case of directed graphs.  Improvements could be made here: it would
-    // be nice if the program explored exactly the same search tree if both
-    // input graphs were complemented.
-    //  #ifdef VSCORE
-    //    vector<int> lgrade(g0.n,0);
-    //    vector<int> rgrade(g1.n,0);
-    //  #endif
-    vector<int> vv0(g0.n);
-    std::iota(std::begin(vv0), std::end(vv0), 0);
-    bool g1_dense = false; //sum(g1_deg) > g1.n * (g1.n - 1);
-    std::stable_sort(std::begin(vv0), std::end(vv0),
-                     [&](int a, int b) { return g1_dense ? (g0_deg[a] < g0_deg[b]) : (g0_deg[a] > g0_deg[b]); });
-
-    vector<int> vv1(g1.n);
-    std::iota(std::begin(vv1), std::end(vv1), 0);
-    bool g0_dense = false; //sum(g0_deg) > g0.n * (g0.n - 1);
-    std::stable_sort(std::begin(vv1), std::end(vv1),
-                     [&](int a, int b) { //????????????????????????????????????????????????????
-                         return g0_dense ? (g1_deg[a] < g1_deg[b]) : (g1_deg[a] > g1_deg[b]);
-                     });
+    PreparedGraph p0 = prepare_graph(std::move(g0), arguments.sort_heuristic);
+    PreparedGraph p1 = prepare_graph(std::move(g1), arguments.sort_heuristic);
     std::cout << "Sorting done" << std::endl;
-
-#if 0
-    int idx;
-    for(idx=0;idx<vv0.size();idx++)
-       cout<<vv0[idx]<<"  ";
-    cout<<endl;
-    for(idx=0;idx<g0_deg.size();idx++)
-       cout<<g0_deg[idx]<<"  ";
-    cout<<endl;
-    for(idx=0;idx<vv1.size();idx++)
-       cout<<vv1[idx]<<"  ";
-    cout<<endl;
-    for(idx=0;idx<g1_deg.size();idx++)
-       cout<<"("<<idx<<","<<g1_deg[idx]<<")  ";
-    cout<<endl;
-
-#endif
-    struct Graph g0_sorted = induced_subgraph(g0, vv0);
-    struct Graph g1_sorted = induced_subgraph(g1, vv1);
     clock_t time_elapsed = clock() - stats->start;
     std::cout << "Induced subgraph calculated in " << time_elapsed * 1000 / CLOCKS_PER_SEC << "ms" << endl;
-#if 0
-    int idx;
-    for(idx=0;idx<g0.n;idx++)
-        cout<<g0.label[idx]<<" ";
-    cout<<endl;
-    for(idx=0;idx<g0_sorted.n;idx++)
-        cout<<g0_sorted.label[idx]<<" ";
-    cout<<endl;
-#endif
 
-    g0_sorted.pack_leaves();
-    g1_sorted.pack_leaves();
+    // decide whether to swap the graphs based on swap_policy
+    if (swap_graphs(p0, p1)) {
+        swap(p0, p1);
+        stats->swapped_graphs = true;
+        cout << "Swapped graphs" << endl;
+    }
+    const Graph &g0_orig = p0.graph;
+    const Graph &g1_orig = p1.graph;
+
+    if (incumbent_stream)
+        incumbent_stream->set_vertex_order(p0.order, p1.order, stats->swapped_graphs);
 
-    DoubleQRewards rewards(g0.n, g1.n);
+    DoubleQRewards rewards(p0.sorted.n, p1.sorted.n);
     if(arguments.initialize_rewards){
-        rewards.initialize(g0_deg, g1_deg);
+        rewards.initialize(p0.scores, p1.scores);
     }
 
     // start clock
     stats->start = clock();
 
-    vector<VtxPair> solution = mcs(g0_sorted, g1_sorted, (void *) &rewards, stats);
+    vector<VtxPair> solution = mcs(p0.sorted, p1.sorted, (void *) &rewards, stats);
 
     // Convert to indices from original, unsorted graphs
     for (auto &vtx_pair: solution) {
-        vtx_pair.v = vv0[vtx_pair.v];
-        vtx_pair.w = vv1[vtx_pair.w];
+        vtx_pair.v = p0.order[vtx_pair.v];
+        vtx_pair.w = p1.order[vtx_pair.w];
     }
 
     // auto stop = std::chrono::steady_clock::now();
@@ -379,21 +434,17 @@ int main(int argc, char **argv) {
     time_elapsed = clock() - stats->start;
     clock_t time_find = stats->bestfind - stats->start;
     /* Clean up the timeout thread */
-#if 1
-    if (timeout_thread.joinable()) {
-        {
-            std::unique_lock<std::mutex> guard(timeout_mutex);
-            stats->abort_due_to_timeout.store(true);
-            timeout_cv.notify_all();
-        }
-        timeout_thread.join();
-    }
-#endif
-    if (!check_sol(g0, g1, solution))
-        cout << "*** Error: Invalid solution" << endl;
+    timeout_watcher.stop();
+    bool aborted = timeout_watcher.expired();
+    if (!check_sol(g0_orig, g1_orig, solution))
+        cerr << "*** Error: Invalid solution" << endl;
 
     cout << "Solution size " << solution.size() << std::endl;
-    for (int i = 0; i < g0.n; i++)
+    if (arguments.decision > 0) {
+        unsigned int goal = decision_goal(p0.sorted.n, p1.sorted.n);
+        cout << "Decision (MCS >= " << goal << "): " << decision_answer(solution.size(), goal, aborted) << endl;
+    }
+    for (int i = 0; i < g0_orig.n; i++)
         for (unsigned int j = 0; j < solution.size(); j++)
             if (solution[j].v == i)
                 cout << "(" << solution[j].v << " -> " << solution[j].w << ") ";
@@ -411,12 +462,17 @@ int main(int argc, char **argv) {
     cout << "  -switch_policy:          " << arguments.reward_policy.switch_policy << endl;
     cout << "  -dal_reward_policy:      " << arguments.reward_policy.dal_reward_policy << endl;
     cout << "  -neighbor_overlap:       " << arguments.reward_policy.neighbor_overlap << endl;
+    cout << "  -warm_start:             " << arguments.warm_start << endl;
+    cout << "  -restart_policy:         " << arguments.restart_policy << endl;
+    cout << "  -twins:                  " << arguments.twins << endl;
 
     cout << endl;
 
     cout << "Nodes:                      " << stats->nodes << endl;
     cout << "Cut branches:               " << stats->cutbranches << endl;
     cout << "Conflicts:                  " << stats->conflicts << endl;
+    cout << "Restarts:                   " << stats->restarts << endl;
+    cout << "Pre-search bound:           " << stats->presearch_bound << (stats->presearch_settled ? " (settled)" : "") << endl;
     printf("CPU time (ms):               %15ld\n", time_elapsed * 1000 / CLOCKS_PER_SEC);
     printf("FindBest time (ms):          %15ld\n", time_find * 1000 / CLOCKS_PER_SEC);
 #ifdef Best
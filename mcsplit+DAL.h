@@ -4,6 +4,7 @@
 #include "graph.h"
 
 #include <algorithm>
+#include <cmath>
 #include <numeric>
 #include <iostream>
 #include <set>
@@ -19,6 +20,10 @@
 #include "args.h"
 #include "reward.h"
 #include "mcs.h"
+#include "solver.h"
+#include "batch.h"
+#include "incumbent_stream.h"
+#include "thread_pool.h"
 #include "heuristics/SortHeuristic.h"
 
 #endif //MCSPLITDAL_MCSPLIT_DAL_H
@@ -26,13 +26,13 @@ void Reward::reset(int value) {
     this->dal_component = 0;
 }
 
-gtype Reward::get_reward(bool normalized) const {
-    if (arguments.reward_policy.current_reward_policy == 0) // RL or LL policy
+gtype Reward::get_reward(int reward_policy, bool normalized) const {
+    if (reward_policy == 0) // RL or LL policy
         if (arguments.mcs_method == RL_DAL)
             return this->rl_component;
         else // if (arguments.mcs_method == LL_DAL)
             return this->ll_component;
-    else if (arguments.reward_policy.current_reward_policy == 1) // DAL policy
+    else if (reward_policy == 1) // DAL policy
         if (normalized)
             return normalized_reward;
         else
@@ -53,7 +53,7 @@ vector<Reward> DoubleQRewards::get_left_rewards() {
 }
 
 vector<Reward> DoubleQRewards::get_right_rewards(int v) {
-    if (arguments.mcs_method == RL_DAL && arguments.reward_policy.current_reward_policy == 0)
+    if (arguments.mcs_method == RL_DAL && reward_policy.current_reward_policy == 0)
         return this->SingleQ;
     else // if (arguments.mcs_method == LL_DAL)
         return this->Q[v];
@@ -77,11 +77,12 @@ void DoubleQRewards::initialize(const vector<int> &left, const vector<int> &righ
             SingleQ[j].ll_component = right[j];
         }
     }
+    mark_all_rows_dirty();
 }
 
-void rotate_reward_policy() {
-    arguments.reward_policy.current_reward_policy = (arguments.reward_policy.current_reward_policy + 1) %
-                                                    arguments.reward_policy.reward_policies_num;
+void DoubleQRewards::rotate_reward_policy() {
+    reward_policy.current_reward_policy = (reward_policy.current_reward_policy + 1) %
+                                          reward_policy.reward_policies_num;
 }
 
 /**
@@ -94,16 +95,21 @@ void DoubleQRewards::reset_rewards() {
             Q[i][j].reset(right_initial_sort_order[j]);
         }
     }
+    mark_all_rows_dirty();
 
     if (arguments.mcs_method == RL_DAL)
         for (int j = 0; j < right_initial_sort_order.size(); j++)
             SingleQ[j].reset(right_initial_sort_order[j]);
 }
 
+void DoubleQRewards::mark_all_rows_dirty() {
+    std::fill(dirty_rows.begin(), dirty_rows.end(), 1);
+}
+
 void DoubleQRewards::randomize_rewards() {
     // TODO to verify if this is correct
     /*
-    for (int i = 0; i < arguments.reward_policy.reward_policies_num; i++) {
+    for (int i = 0; i < reward_policy.reward_policies_num; i++) {
         for (int j = 0; j < n; j++) {
             V[i][j] = (gtype) rand() / RAND_MAX;    // TODO what should be the upper bound? probably very low, so that it decays very fast
             for (int k = 0; k < m; k++) {
@@ -117,12 +123,12 @@ void DoubleQRewards::randomize_rewards() {
 
 void DoubleQRewards::update_policy_counter(const bool restart_counter) {
     if (restart_counter) { // A better solution was found, reset the counter
-        arguments.reward_policy.policy_switch_counter = 0;
+        reward_policy.policy_switch_counter = 0;
     } else { // Increase the policy counter
-        arguments.reward_policy.policy_switch_counter++;
-        if (arguments.reward_policy.policy_switch_counter > arguments.reward_policy.reward_switch_policy_threshold) {
-            arguments.reward_policy.policy_switch_counter = 0;
-            switch (arguments.reward_policy.switch_policy) {
+        reward_policy.policy_switch_counter++;
+        if (reward_policy.policy_switch_counter > reward_policy.reward_switch_policy_threshold) {
+            reward_policy.policy_switch_counter = 0;
+            switch (reward_policy.switch_policy) {
                 case NO_CHANGE:
                     // Do nothing
                     break;
@@ -153,15 +159,15 @@ void DoubleQRewards::update_rewards(const NewBidomainResult &new_domains_result,
 
     // Compute DAL reward
     gtype dal_reward = 0;
-    if (arguments.reward_policy.dal_reward_policy == DAL_REWARD_MAX_NUM_DOMAINS)
+    if (reward_policy.dal_reward_policy == DAL_REWARD_MAX_NUM_DOMAINS)
         dal_reward = new_domains.size();
-    else if (arguments.reward_policy.dal_reward_policy == DAL_REWARD_MIN_MAX_DOMAIN_SIZE) {
+    else if (reward_policy.dal_reward_policy == DAL_REWARD_MIN_MAX_DOMAIN_SIZE) {
         auto max_bidomain = std::max_element(new_domains.begin(), new_domains.end(),
                                              [](const Bidomain &bd1, const Bidomain &bd2) {
                                                  return bd1.get_max_len() < bd2.get_max_len();
                                              });
         dal_reward = -max_bidomain->get_max_len() / 100; // partial rounding + normalization (to remove?)
-    } else if (arguments.reward_policy.dal_reward_policy == DAL_REWARD_MIN_AVG_DOMAIN_SIZE) {
+    } else if (reward_policy.dal_reward_policy == DAL_REWARD_MIN_AVG_DOMAIN_SIZE) {
         int total = 0;
         for (const Bidomain &bd: new_domains) {
             total += bd.get_max_len();
@@ -176,9 +182,11 @@ void DoubleQRewards::update_rewards(const NewBidomainResult &new_domains_result,
         V[v].update(reward, dal_reward);
         SingleQ[w].update(reward, dal_reward);
         Q[v][w].update(reward, dal_reward);
+        if (!dirty_rows.empty()) // only row v changes, below too
+            dirty_rows[v] = 1;
 
         // Do not decay if current policy is RL!
-        if (arguments.mcs_method != RL_DAL || arguments.reward_policy.current_reward_policy != 0) {
+        if (arguments.mcs_method != RL_DAL || reward_policy.current_reward_policy != 0) {
             // TODO if we normalize, we might have to adjust the thresholds
             if (get_vertex_reward(v, false) > short_memory_threshold)
                 for (auto &r: V)
@@ -191,13 +199,13 @@ void DoubleQRewards::update_rewards(const NewBidomainResult &new_domains_result,
 }
 
 gtype DoubleQRewards::get_vertex_reward(int v, bool normalized) const {
-    return V[v].get_reward(normalized);
+    return V[v].get_reward(reward_policy.current_reward_policy, normalized);
 }
 
 gtype DoubleQRewards::get_pair_reward(int v, int w, bool normalized) const {
-    if (arguments.mcs_method == RL_DAL && arguments.reward_policy.current_reward_policy == 0)
-        return SingleQ[w].get_reward(normalized);
+    if (arguments.mcs_method == RL_DAL && reward_policy.current_reward_policy == 0)
+        return SingleQ[w].get_reward(reward_policy.current_reward_policy, normalized);
     else // if (arguments.mcs_method == LL_DAL)
-        return Q[v][w].get_reward(normalized);
+        return Q[v][w].get_reward(reward_policy.current_reward_policy, normalized);
 }
 
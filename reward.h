@@ -15,7 +15,7 @@ struct Reward{
 
     Reward() : rl_component(0), ll_component(0), dal_component(0), normalized_reward(0.0) {}
     void normalize(int rl_max, int dal_max, double factor);
-    gtype get_reward(bool normalized) const;
+    gtype get_reward(int reward_policy, bool normalized) const;
     void reset(int value);
     void decay();
     void update(gtype ll_reward, gtype dal_reward);
@@ -33,20 +33,28 @@ struct Rewards{
 };
 
 struct DoubleQRewards : Rewards{
+    // per-search copy of arguments.reward_policy, so that concurrent searches do not share policy state
+    RewardPolicy reward_policy;
     vector<Reward> V;
     vector<vector<Reward>> Q;
     vector<Reward> SingleQ;
     vector<int> left_initial_sort_order;
     vector<int> right_initial_sort_order;
+    // rows of Q changed since the flags were last cleared; empty while nobody tracks them (see CheckpointWriter)
+    vector<char> dirty_rows;
 
-    DoubleQRewards(int n, int m) : Rewards(n,m), V(n), Q(n , vector<Reward>(m)), SingleQ(m), left_initial_sort_order(n,0), right_initial_sort_order(n,0){};
+    DoubleQRewards(int n, int m) : Rewards(n,m), reward_policy(arguments.reward_policy), V(n), Q(n , vector<Reward>(m)), SingleQ(m), left_initial_sort_order(n,0), right_initial_sort_order(n,0){
+        reward_policy.reward_switch_policy_threshold = 2 * std::min(n, m);
+    };
     vector<Reward> get_left_rewards() override;
     vector<Reward> get_right_rewards(int v) override;
     void initialize(const vector<int> &left, const vector<int> &right) override;
     void update_policy_counter(bool restart_counter) override;
     gtype get_vertex_reward(int v, bool normalized) const override;
     gtype get_pair_reward(int v, int w, bool normalized) const override;
+    void rotate_reward_policy();
     void reset_rewards();
+    void mark_all_rows_dirty();
     void randomize_rewards();
     void update_rewards(const NewBidomainResult &new_domains_result, int v, int w, Stats *stats) override;
 };
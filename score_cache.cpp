@@ -0,0 +1,96 @@
+#include "score_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+// the version (last character) changes whenever a heuristic computes different scores, so that old files are redone
+static const char score_cache_magic[8] = {'M', 'C', 'S', 'D', 'A', 'L', 'S', '3'};
+
+// <fingerprint>-<heuristic>.scores, keeping only the characters that are safe in a file name
+static std::string cache_path(const char *directory, unsigned long long fingerprint, const std::string &name) {
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", fingerprint);
+    std::string file = std::string(hex) + "-";
+    for (char c: name)
+        file += std::isalnum((unsigned char) c) || c == '.' || c == '=' ? c : '_';
+    return (std::filesystem::path(directory) / (file + ".scores")).string();
+}
+
+static bool read_scores(const std::string &path, unsigned long long fingerprint, const std::string &name, int n,
+                        std::vector<int> &scores) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    char magic[sizeof(score_cache_magic)];
+    unsigned long long stored_fingerprint = 0;
+    int stored_n = -1;
+    unsigned int name_length = 0;
+    in.read(magic, sizeof(magic));
+    in.read((char *) &stored_fingerprint, sizeof(stored_fingerprint));
+    in.read((char *) &stored_n, sizeof(stored_n));
+    in.read((char *) &name_length, sizeof(name_length));
+    if (!in || !std::equal(magic, magic + sizeof(magic), score_cache_magic) || stored_fingerprint != fingerprint ||
+        stored_n != n || name_length != name.size())
+        return false;
+    std::string stored_name(name_length, '\0');
+    in.read(&stored_name[0], name_length);
+    if (!in || stored_name != name)
+        return false;
+    scores.resize(n);
+    in.read((char *) scores.data(), (std::streamsize) n * sizeof(int));
+    // nothing may follow the scores
+    return in && in.peek() == std::ifstream::traits_type::eof();
+}
+
+static void write_scores(const std::string &path, unsigned long long fingerprint, const std::string &name,
+                         const std::vector<int> &scores) {
+    // graphs may be prepared concurrently (batch mode), each writer gets its own temporary file
+    static std::atomic<unsigned int> writes(0);
+    std::string tmp_path = path + ".tmp" + std::to_string(getpid()) + "-" + std::to_string(writes++);
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Cannot write score cache " << tmp_path << std::endl;
+            return;
+        }
+        int n = (int) scores.size();
+        unsigned int name_length = name.size();
+        out.write(score_cache_magic, sizeof(score_cache_magic));
+        out.write((const char *) &fingerprint, sizeof(fingerprint));
+        out.write((const char *) &n, sizeof(n));
+        out.write((const char *) &name_length, sizeof(name_length));
+        out.write(name.data(), name_length);
+        out.write((const char *) scores.data(), (std::streamsize) n * sizeof(int));
+        if (!out) {
+            std::cerr << "Cannot write score cache " << tmp_path << std::endl;
+            out.close();
+            std::remove(tmp_path.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Cannot replace score cache " << path << std::endl;
+        std::remove(tmp_path.c_str());
+    }
+}
+
+std::vector<int> cached_scores(const char *directory, const Graph &g, SortHeuristic::Base *sort_heuristic) {
+    unsigned long long fingerprint = graph_fingerprint(g);
+    std::string name = sort_heuristic->name();
+    std::string path = cache_path(directory, fingerprint, name);
+    std::vector<int> scores;
+    if (read_scores(path, fingerprint, name, g.n, scores))
+        return scores;
+    scores = sort_heuristic->sort(g);
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    write_scores(path, fingerprint, name, scores);
+    return scores;
+}
@@ -0,0 +1,16 @@
+#ifndef MCSPLITDAL_SCORE_CACHE_H
+#define MCSPLITDAL_SCORE_CACHE_H
+
+#include <vector>
+#include "graph.h"
+#include "heuristics/SortHeuristic.h"
+
+/**
+ * Scores of the sort heuristic on g, kept in a directory so that repeated runs on the same graphs skip the
+ * heuristic. Each file holds the scores of one graph (identified by its fingerprint) under one heuristic
+ * (identified by its name(), which includes its parameters), as a binary array of ints. Missing, stale or
+ * corrupted files are recomputed and rewritten; a cache that cannot be written only costs the recomputation.
+ */
+std::vector<int> cached_scores(const char *directory, const Graph &g, SortHeuristic::Base *sort_heuristic);
+
+#endif //MCSPLITDAL_SCORE_CACHE_H
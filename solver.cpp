@@ -0,0 +1,232 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include "reward.h"
+#include "score_cache.h"
+
+TimeoutWatcher::TimeoutWatcher(Stats *stats, int timeout) : stats(stats), aborted(false) {
+    if (0 == timeout)
+        return;
+    thread = std::thread([this, timeout] {
+        auto abort_time = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
+        {
+            /* Sleep until either we've reached the time limit,
+             * or we've finished all the work. */
+            std::unique_lock<std::mutex> guard(mutex);
+            while (!this->stats->abort_due_to_timeout.load()) {
+                if (std::cv_status::timeout == cv.wait_until(guard, abort_time)) {
+                    /* We've woken up, and it's due to a timeout. */
+                    aborted = true;
+                    break;
+                }
+            }
+        }
+        this->stats->abort();
+    });
+}
+
+TimeoutWatcher::~TimeoutWatcher() {
+    stop();
+}
+
+void TimeoutWatcher::stop() {
+    if (thread.joinable()) {
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            stats->abort();
+            cv.notify_all();
+        }
+        thread.join();
+    }
+}
+
+char input_format() {
+    return arguments.dimacs ? 'D' : arguments.lad ? 'L' : arguments.ascii ? 'A' : 'B';
+}
+
+Graph read_input_graph(char *filename) {
+    return readGraph(filename, input_format(), arguments.directed, arguments.edge_labelled,
+                     arguments.vertex_labelled);
+}
+
+// 2|E| / n(n-1), from the adjacency lists
+static double edge_density(const Graph &g) {
+    if (g.n < 2)
+        return 0;
+    double degree_sum = 0;
+    for (auto &node: g.adjlist)
+        degree_sum += node.adjNodes.size();
+    return degree_sum / ((double) g.n * (g.n - 1));
+}
+
+static bool complement_candidate(const Graph &g) {
+    if (!arguments.complement || arguments.connected || arguments.directed || arguments.edge_labelled)
+        return false;
+    return edge_density(g) > 0.5;
+}
+
+struct ComplementCache {
+    SortHeuristic::Base *sort_heuristic;
+    std::once_flag built;
+    std::unique_ptr<PreparedGraph> graph;
+};
+
+PreparedGraph prepare_graph(Graph g, SortHeuristic::Base *sort_heuristic) {
+    PreparedGraph p;
+    if (complement_candidate(g)) {
+        p.complement_cache = std::make_shared<ComplementCache>();
+        p.complement_cache->sort_heuristic = sort_heuristic;
+    }
+    p.density = g.computeDensity();
+    p.scores = arguments.score_cache ? cached_scores(arguments.score_cache, g, sort_heuristic)
+                                     : sort_heuristic->sort(g);
+
+    // As implemented here, g_dense is false for all instances
+    // in the Experimental Evaluation section of the paper.  Thus,
+    // we always sort the vertices in descending order of degree (or total degree,
+    // in the case of directed graphs.  Improvements could be made here: it would
+    // be nice if the program explored exactly the same search tree if both
+    // input graphs were complemented.
+    p.order = vector<int>(g.n);
+    std::iota(std::begin(p.order), std::end(p.order), 0);
+    bool g_dense = false; //sum(scores) > g.n * (g.n - 1);
+    const vector<int> &scores = p.scores;
+    std::stable_sort(std::begin(p.order), std::end(p.order),
+                     [&](int a, int b) { return g_dense ? (scores[a] < scores[b]) : (scores[a] > scores[b]); });
+
+    p.sorted = induced_subgraph(g, p.order);
+    p.sorted.pack_leaves();
+    if (arguments.twins)
+        p.sorted.compute_twin_classes();
+    p.graph = std::move(g);
+    return p;
+}
+
+bool use_complements(const Graph &g0, const Graph &g1) {
+    return complement_candidate(g0) && complement_candidate(g1);
+}
+
+const PreparedGraph &complement_of(const PreparedGraph &p) {
+    ComplementCache &cache = *p.complement_cache;
+    std::call_once(cache.built, [&] {
+        cache.graph = std::make_unique<PreparedGraph>(prepare_graph(complement(p.graph), cache.sort_heuristic));
+        cache.graph->name = p.name;
+    });
+    return *cache.graph;
+}
+
+/**
+ * based on arguments.swap_policy, return true if the graphs needs to be swapped.
+ * McSPLIT_SD and McSPLIT_SO are based on Trimble's PHD thesis https://theses.gla.ac.uk/83350/
+ */
+bool swap_graphs(const PreparedGraph &g0, const PreparedGraph &g1) {
+    switch (arguments.swap_policy) {
+        case McSPLIT_SD: { // swap if density extremeness of g1 is bigger than that of g0
+            // compute density extremeness
+            double de0 = abs(0.5 - g0.density);
+            double de1 = abs(0.5 - g1.density);
+            return de1 > de0;
+        }
+        case McSPLIT_SO:
+            return g1.graph.n > g0.graph.n;
+        default:
+            cerr << "swap policy unknown" << endl;
+        case NO_SWAP:
+            return false;
+    }
+}
+
+bool check_sol(const Graph &g0, const Graph &g1, const vector<VtxPair> &solution) {
+    vector<bool> used_left(g0.n, false);
+    vector<bool> used_right(g1.n, false);
+    for (unsigned int i = 0; i < solution.size(); i++)
+    {
+        struct VtxPair p0 = solution[i];
+        if (used_left[p0.v] || used_right[p0.w])
+        {
+            cerr << "Used left: " << used_left[p0.v] << endl;
+            cerr << "Used right: " << used_right[p0.w] << endl;
+            return false;
+        }
+        used_left[p0.v] = true;
+        used_right[p0.w] = true;
+        if (g0.adjlist[p0.v].label != g1.adjlist[p0.w].label)
+        {
+            cerr << g0.adjlist[p0.v].label << " != " << g1.adjlist[p0.w].label << endl;
+            return false;
+        }
+        for (unsigned int j = i + 1; j < solution.size(); j++)
+        {
+            struct VtxPair p1 = solution[j];
+            if (g0.get(p0.v, p1.v) != g1.get(p0.w, p1.w))
+            {
+                cerr << "Edge left (" << p0.v << " -> " << p1.v << ") = " << g0.get(p0.v, p1.v) << endl;
+                cerr << "Edge right (" << p0.w << " -> " << p1.w << ") = " << g1.get(p0.w, p1.w) << endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Solve a single pair of prepared graphs with the current arguments.
+ * Only local state is modified, so several pairs can be solved concurrently.
+ */
+PairResult solve_pair(const PreparedGraph &g0, const PreparedGraph &g1, int timeout) {
+    PairResult result;
+    const PreparedGraph *left = &g0;
+    const PreparedGraph *right = &g1;
+    if (use_complements(g0.graph, g1.graph)) {
+        left = &complement_of(g0);
+        right = &complement_of(g1);
+        result.complemented = true;
+    }
+    if (swap_graphs(*left, *right)) {
+        std::swap(left, right);
+        result.swapped = true;
+    }
+
+    Stats stats_s;
+    Stats *stats = &stats_s;
+    stats->abort_due_to_timeout.store(false);
+    stats->swapped_graphs = result.swapped;
+    TimeoutWatcher watcher(stats, timeout);
+
+    DoubleQRewards rewards(left->sorted.n, right->sorted.n);
+    if (arguments.initialize_rewards)
+        rewards.initialize(left->scores, right->scores);
+
+    auto start = std::chrono::steady_clock::now();
+    stats->start = clock();
+    vector<VtxPair> solution = mcs(left->sorted, right->sorted, (void *) &rewards, stats);
+    auto stop = std::chrono::steady_clock::now();
+    watcher.stop();
+
+    // Convert to indices from original, unsorted and unswapped graphs
+    for (auto &vtx_pair: solution) {
+        vtx_pair.v = left->order[vtx_pair.v];
+        vtx_pair.w = right->order[vtx_pair.w];
+        if (result.swapped)
+            std::swap(vtx_pair.v, vtx_pair.w);
+    }
+
+    result.solution = std::move(solution);
+    result.nodes = stats->nodes;
+    result.bound = stats->presearch_bound;
+    result.settled = stats->presearch_settled;
+    result.time_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+    result.timed_out = watcher.expired();
+    if (arguments.decision > 0)
+        result.decision_goal = decision_goal(left->sorted.n, right->sorted.n);
+    return result;
+}
+
+const char *decision_answer(size_t solution_size, unsigned int decision_goal, bool timed_out) {
+    if (solution_size >= decision_goal)
+        return "yes";
+    return timed_out ? "unknown" : "no";
+}
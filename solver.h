@@ -0,0 +1,93 @@
+#ifndef MCSPLITDAL_SOLVER_H
+#define MCSPLITDAL_SOLVER_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "graph.h"
+#include "mcs.h"
+#include "stats.h"
+#include "heuristics/SortHeuristic.h"
+
+/**
+ * A graph that went through the mcsplit-dal preprocessing (sort heuristic, induced_subgraph, pack_leaves).
+ * It can be reused, read-only, by any number of searches.
+ */
+struct PreparedGraph {
+    std::string name;
+    Graph graph;            // original graph, used to check solutions
+    Graph sorted;           // graph relabelled by decreasing score, with packed leaves
+    std::vector<int> order; // order[i] = index in the original graph of vertex i of the sorted graph
+    std::vector<int> scores; // sort heuristic scores, indexed as the original graph
+    float density;
+    // holds the graph prepared on its complement once a pair needs it, if it is dense (see complement_of)
+    std::shared_ptr<struct ComplementCache> complement_cache;
+
+    PreparedGraph() : graph(0), sorted(0), density(0) {}
+};
+
+struct PairResult {
+    std::vector<VtxPair> solution; // indices of the original (unsorted, unswapped) graphs
+    unsigned long long nodes = 0;
+    int bound = -1; // pre-search upper bound
+    bool settled = false; // solved by the pre-search bounds alone
+    double time_ms = 0;
+    bool timed_out = false;
+    bool swapped = false;
+    bool complemented = false; // solved on the complement graphs
+    unsigned int decision_goal = 0; // threshold of the decision mode, 0 if disabled
+};
+
+/**
+ * Sets stats->abort_due_to_timeout after `timeout` seconds, unless stop() is called first.
+ * A timeout of 0 disables the watcher.
+ */
+class TimeoutWatcher {
+public:
+    TimeoutWatcher(Stats *stats, int timeout);
+    ~TimeoutWatcher();
+    void stop();
+    bool expired() const { return aborted; }
+private:
+    Stats *stats;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool aborted;
+};
+
+char input_format();
+
+Graph read_input_graph(char *filename);
+
+PreparedGraph prepare_graph(Graph g, SortHeuristic::Base *sort_heuristic);
+
+/**
+ * Induced MCS is the same on the complements of both graphs: solve there when both graphs have density above
+ * 0.5 (on by default, off with --no-complement). Not in connected mode, where connectivity is not preserved,
+ * nor for directed or edge labelled graphs, whose edge values the complement does not keep.
+ */
+bool use_complements(const Graph &g0, const Graph &g1);
+
+/**
+ * p prepared on the complement of its graph, for a pair where use_complements() holds. It is built by the first
+ * pair that needs it and kept for the next ones; thread-safe.
+ */
+const PreparedGraph &complement_of(const PreparedGraph &p);
+
+bool swap_graphs(const PreparedGraph &g0, const PreparedGraph &g1);
+
+bool check_sol(const Graph &g0, const Graph &g1, const vector<VtxPair> &solution);
+
+PairResult solve_pair(const PreparedGraph &g0, const PreparedGraph &g1, int timeout);
+
+/**
+ * Answer of the decision mode: "yes" if a solution of at least decision_goal vertices was found,
+ * "no" if the search proved there is none, "unknown" if it timed out first.
+ */
+const char *decision_answer(size_t solution_size, unsigned int decision_goal, bool timed_out);
+
+#endif //MCSPLITDAL_SOLVER_H
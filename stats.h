@@ -1,8 +1,13 @@
 #ifndef MCSPLITDAL_STATS_H
 #define MCSPLITDAL_STATS_H
 
+#include <algorithm>
 #include <chrono>
 #include <atomic>
+#include <mutex>
+#include <vector>
+
+class IncumbentStream;
 
 typedef struct Stats {
     unsigned long long nodes{0};
@@ -14,6 +19,40 @@ typedef struct Stats {
     clock_t start;
     std::atomic<bool> abort_due_to_timeout;
     bool swapped_graphs = false;
+    int presearch_bound = -1;       // upper bound computed before the search
+    bool presearch_settled = false; // the pre-search bounds solved the instance
+    unsigned long long restart_node_limit = 0; // the current restart phase ends at this node count (0: no limit)
+    bool restart_limit_hit = false;
+    int restarts = 0;
+    IncumbentStream *incumbent_stream = nullptr; // where to publish each new incumbent, if anywhere
+    // vertices of the stream's graphs that the searched vertices stand for, when searching subgraphs of them
+    const std::vector<int> *stream_vertices0 = nullptr, *stream_vertices1 = nullptr;
+    std::atomic<unsigned int> *shared_best = nullptr; // best size found by concurrent searches, if any
+
+    // Stop this search and the searches running on its behalf (parallel goals, component pairs) registered with
+    // add_child(). A child added after abort() starts aborted.
+    void abort() {
+        std::lock_guard<std::mutex> guard(children_mutex);
+        abort_due_to_timeout = true;
+        for (Stats *child: children)
+            child->abort();
+    }
+
+    void add_child(Stats *child) {
+        std::lock_guard<std::mutex> guard(children_mutex);
+        children.push_back(child);
+        if (abort_due_to_timeout)
+            child->abort();
+    }
+
+    void remove_child(Stats *child) {
+        std::lock_guard<std::mutex> guard(children_mutex);
+        children.erase(std::find(children.begin(), children.end(), child));
+    }
+
+private:
+    std::mutex children_mutex;
+    std::vector<Stats *> children;
 } Stats;
 
 #endif //MCSPLITDAL_STATS_H
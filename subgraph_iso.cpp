@@ -0,0 +1,263 @@
+#include "subgraph_iso.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+
+using Word = unsigned long long;
+const int word_bits = 64;
+
+// satisfiable instances have heavy-tailed run times: restart with a randomised value order every so many nodes
+const int si_restarts = 24;
+const unsigned long long si_restart_base = 1000;
+const double si_restart_factor = 1.5;
+
+/**
+ * Adjacency matrix as bitset rows
+ */
+struct BitRows {
+    int n;
+    int words;
+    vector<Word> bits;
+
+    explicit BitRows(const Graph &g) : n(g.n), words((g.n + word_bits - 1) / word_bits),
+                                       bits((size_t) g.n * words, 0) {
+        for (int u = 0; u < g.n; u++)
+            for (auto &node: g.adjlist[u].adjNodes)
+                bits[(size_t) u * words + node.id / word_bits] |= 1ULL << (node.id % word_bits);
+    }
+
+    const Word *row(int u) const { return &bits[(size_t) u * words]; }
+
+    bool get(int u, int v) const { return row(u)[v / word_bits] >> (v % word_bits) & 1; }
+};
+
+static int popcount(const Word *set, int words) {
+    int count = 0;
+    for (int i = 0; i < words; i++)
+        count += __builtin_popcountll(set[i]);
+    return count;
+}
+
+// sorted (decreasing) degrees of the neighbours of each vertex
+static vector<vector<int>> neighbourhood_degree_sequences(const Graph &g) {
+    vector<vector<int>> nds(g.n);
+    for (int u = 0; u < g.n; u++) {
+        for (auto &node: g.adjlist[u].adjNodes)
+            nds[u].push_back((int) g.adjlist[node.id].adjNodes.size());
+        std::sort(nds[u].begin(), nds[u].end(), std::greater<int>());
+    }
+    return nds;
+}
+
+/**
+ * Domains of the unassigned pattern vertices at one level of the search, stored contiguously
+ */
+struct SIDomains {
+    vector<int> vars;
+    vector<int> counts;
+    vector<Word> bits; // vars.size() rows of `words` words
+
+    Word *row(int i, int words) { return &bits[(size_t) i * words]; }
+};
+
+class InducedSI {
+public:
+    InducedSI(const Graph &pattern, const Graph &target, Stats *stats)
+            : pattern(pattern), target(target), p_adj(pattern), t_adj(target), words(t_adj.words),
+              stats(stats), assignment(pattern.n, -1) {
+        // non-neighbours of a target vertex: every vertex but itself and its neighbours
+        last_word_mask = target.n % word_bits ? (1ULL << (target.n % word_bits)) - 1 : ~0ULL;
+    }
+
+    SIResult run(vector<VtxPair> &embedding) {
+        SIDomains root;
+        if (!initial_domains(root))
+            return SI_NOT_FOUND;
+        // the last run has no node limit, so that the search stays complete
+        bool found = false;
+        for (int restart = 0; restart <= si_restarts && !found && !aborted; restart++) {
+            node_limit = restart < si_restarts ? stats->nodes + (unsigned long long) (
+                    si_restart_base * std::pow(si_restart_factor, restart)) : 0;
+            randomise = restart > 0;
+            limit_hit = false;
+            SIDomains d = root;
+            found = search(d);
+            if (!found && !limit_hit) // the whole tree was searched
+                break;
+        }
+        if (aborted)
+            return SI_ABORTED;
+        if (!found)
+            return SI_NOT_FOUND;
+        embedding.clear();
+        for (int p = 0; p < pattern.n; p++)
+            embedding.emplace_back(p, assignment[p]);
+        return SI_FOUND;
+    }
+
+private:
+    const Graph &pattern;
+    const Graph &target;
+    BitRows p_adj;
+    BitRows t_adj;
+    int words;
+    Word last_word_mask;
+    Stats *stats;
+    vector<int> assignment;
+    bool aborted = false;
+    unsigned long long node_limit = 0; // 0: no limit
+    bool limit_hit = false;
+    bool randomise = false;
+    std::mt19937 rng{0};
+
+    bool initial_domains(SIDomains &d) {
+        if (pattern.n > target.n)
+            return false;
+        auto p_nds = neighbourhood_degree_sequences(pattern);
+        auto t_nds = neighbourhood_degree_sequences(target);
+        d.bits.assign((size_t) pattern.n * words, 0);
+        for (int p = 0; p < pattern.n; p++) {
+            int p_deg = (int) p_nds[p].size();
+            int p_non_deg = pattern.n - 1 - p_deg;
+            Word *row = d.row(p, words);
+            for (int t = 0; t < target.n; t++) {
+                int t_deg = (int) t_nds[t].size();
+                if (pattern.adjlist[p].label != target.adjlist[t].label || t_deg < p_deg ||
+                    target.n - 1 - t_deg < p_non_deg)
+                    continue;
+                // the i-th largest neighbour degree of t must be at least that of p
+                bool dominated = true;
+                for (int i = 0; i < p_deg && dominated; i++)
+                    dominated = t_nds[t][i] >= p_nds[p][i];
+                if (dominated)
+                    row[t / word_bits] |= 1ULL << (t % word_bits);
+            }
+            d.vars.push_back(p);
+            d.counts.push_back(popcount(row, words));
+        }
+        return all_different_ok(d);
+    }
+
+    /**
+     * Counting all-different check: taking the domains by increasing size, the union of the first k must have
+     * at least k values
+     */
+    bool all_different_ok(SIDomains &d) {
+        vector<int> order(d.vars.size());
+        for (unsigned int i = 0; i < order.size(); i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return d.counts[a] < d.counts[b]; });
+        vector<Word> all(words, 0);
+        for (unsigned int k = 0; k < order.size(); k++) {
+            if (d.counts[order[k]] == 0)
+                return false;
+            const Word *row = d.row(order[k], words);
+            for (int i = 0; i < words; i++)
+                all[i] |= row[i];
+            if (popcount(all.data(), words) < (int) k + 1)
+                return false;
+        }
+        return true;
+    }
+
+    bool search(SIDomains &d) {
+        if (d.vars.empty())
+            return true;
+
+        // smallest domain relative to the pattern degree first (dom/deg), ties on the largest degree
+        int best = 0;
+        for (unsigned int i = 1; i < d.vars.size(); i++) {
+            long long deg_i = pattern.adjlist[d.vars[i]].adjNodes.size() + 1;
+            long long deg_best = pattern.adjlist[d.vars[best]].adjNodes.size() + 1;
+            long long lhs = d.counts[i] * deg_best, rhs = d.counts[best] * deg_i;
+            if (lhs < rhs || (lhs == rhs && deg_i > deg_best))
+                best = i;
+        }
+        int p = d.vars[best];
+        vector<int> candidates;
+        const Word *row = d.row(best, words);
+        for (int wi = 0; wi < words; wi++)
+            for (Word word = row[wi]; word; word &= word - 1)
+                candidates.push_back(wi * word_bits + __builtin_ctzll(word));
+        if (randomise)
+            std::shuffle(candidates.begin(), candidates.end(), rng);
+
+        SIDomains child;
+        for (int t: candidates) {
+            if (stats->abort_due_to_timeout) {
+                aborted = true;
+                return false;
+            }
+            if (node_limit && stats->nodes >= node_limit) {
+                limit_hit = true;
+                return false;
+            }
+            stats->nodes++;
+            if (!propagate(d, best, t, child))
+                continue;
+            assignment[p] = t;
+            if (search(child))
+                return true;
+            if (aborted || limit_hit)
+                return false;
+            assignment[p] = -1;
+        }
+        return false;
+    }
+
+    // domains of the other variables once d.vars[assigned] = t; false on a wipe-out
+    bool propagate(SIDomains &d, int assigned, int t, SIDomains &child) {
+        int p = d.vars[assigned];
+        const Word *t_row = t_adj.row(t);
+        child.vars.clear();
+        child.counts.clear();
+        child.bits.resize((d.vars.size() - 1) * words);
+        int k = 0;
+        for (unsigned int i = 0; i < d.vars.size(); i++) {
+            if ((int) i == assigned)
+                continue;
+            int q = d.vars[i];
+            const Word *row = d.row(i, words);
+            Word *out = child.row(k, words);
+            if (p_adj.get(p, q)) {
+                for (int wi = 0; wi < words; wi++)
+                    out[wi] = row[wi] & t_row[wi];
+            } else {
+                for (int wi = 0; wi < words; wi++)
+                    out[wi] = row[wi] & ~t_row[wi];
+                out[words - 1] &= last_word_mask;
+            }
+            out[t / word_bits] &= ~(1ULL << (t % word_bits));
+            int count = popcount(out, words);
+            if (count == 0)
+                return false;
+            child.vars.push_back(q);
+            child.counts.push_back(count);
+            k++;
+        }
+        return all_different_ok(child);
+    }
+};
+
+SIResult induced_subgraph_isomorphism(const Graph &pattern, const Graph &target, vector<VtxPair> &embedding,
+                                      Stats *stats) {
+    InducedSI si(pattern, target, stats);
+    return si.run(embedding);
+}
+
+bool is_connected(const Graph &g) {
+    if (g.n == 0)
+        return true;
+    vector<char> seen(g.n, 0);
+    vector<int> queue{0};
+    seen[0] = 1;
+    for (size_t head = 0; head < queue.size(); head++)
+        for (auto &node: g.adjlist[queue[head]].adjNodes)
+            if (!seen[node.id]) {
+                seen[node.id] = 1;
+                queue.push_back(node.id);
+            }
+    return (int) queue.size() == g.n;
+}
@@ -0,0 +1,29 @@
+#ifndef MCSPLITDAL_SUBGRAPH_ISO_H
+#define MCSPLITDAL_SUBGRAPH_ISO_H
+
+#include <vector>
+#include "graph.h"
+#include "mcs.h"
+#include "stats.h"
+
+enum SIResult {
+    SI_FOUND,
+    SI_NOT_FOUND,
+    SI_ABORTED
+};
+
+/**
+ * Induced subgraph isomorphism: look for an embedding of the whole pattern into the target that preserves labels,
+ * edges and non-edges. Much stronger filtering applies than in the MCS search:
+ *  - label, degree and non-degree filtering, and neighbourhood degree sequence dominance for the initial domains;
+ *  - forward checking of adjacency and non-adjacency after each assignment;
+ *  - a counting all-different check (no set of k domains may have fewer than k values in their union).
+ * Domains are bitsets over the target vertices. On SI_FOUND, embedding holds (pattern vertex, target vertex)
+ * pairs. Nodes are counted in stats->nodes and stats->abort_due_to_timeout is honoured.
+ */
+SIResult induced_subgraph_isomorphism(const Graph &pattern, const Graph &target, vector<VtxPair> &embedding,
+                                      Stats *stats);
+
+bool is_connected(const Graph &g);
+
+#endif //MCSPLITDAL_SUBGRAPH_ISO_H
@@ -0,0 +1,97 @@
+/**
+ * Connected mode warm start: on random sparse graphs, where dropping a pair often cuts a solution in two, the
+ * destroy-and-repair moves must only produce connected solutions, and seeding the search with them must not
+ * change the size of the maximum common connected subgraph.
+ */
+#include <cstdio>
+#include <random>
+
+#include "../mcsplit+DAL.h"
+#include "../warm_start.h"
+
+static Graph random_graph(int n, double density, std::mt19937 &rng) {
+    Graph g(n);
+    std::bernoulli_distribution edge(density);
+    int e = 0;
+    for (int u = 0; u < n; u++)
+        for (int v = u + 1; v < n; v++)
+            if (edge(rng)) {
+                g.adjlist[u].adjNodes.push_back(Node(v, 1));
+                g.adjlist[v].adjNodes.push_back(Node(u, 1));
+                e++;
+            }
+    g.e = e;
+    g.pack_leaves();
+    return g;
+}
+
+// whether the vertices of g0 (or of g1, with right) in the matching induce a connected subgraph
+static bool connected_matching(const vector<VtxPair> &matching, const Graph &g, bool right) {
+    vector<int> vertices;
+    for (const VtxPair &pr: matching)
+        vertices.push_back(right ? pr.w : pr.v);
+    return connected_components(vertex_subgraph(g, vertices), 1).size() <= 1;
+}
+
+static void set_test_arguments() {
+    arguments.quiet = true;
+    arguments.connected = true;
+    arguments.heuristic = min_max;
+    arguments.mcs_method = RL_DAL;
+    arguments.max_iter = -1;
+    arguments.parallel_goals = 1;
+    arguments.restart_policy = NO_RESTARTS;
+    arguments.threads = 1;
+    arguments.reward_policy.current_reward_policy = 1;
+    arguments.reward_policy.reward_policies_num = 2;
+    arguments.reward_policy.switch_policy = CHANGE;
+    arguments.reward_policy.dal_reward_policy = DAL_REWARD_MAX_NUM_DOMAINS;
+    arguments.reward_policy.neighbor_overlap = NO_OVERLAP;
+}
+
+static unsigned int solve(const Graph &g0, const Graph &g1, double warm_start_fraction) {
+    arguments.warm_start = warm_start_fraction;
+    DoubleQRewards rewards(g0.n, g1.n);
+    Stats stats;
+    stats.abort_due_to_timeout = false;
+    stats.start = clock();
+    return mcs(g0, g1, &rewards, &stats).size();
+}
+
+int main() {
+    set_test_arguments();
+    init_thread_pool(1, false);
+    std::mt19937 rng(7);
+    int failures = 0;
+    for (int instance = 0; instance < 100; instance++) {
+        int n0 = 10 + rng() % 7, n1 = 10 + rng() % 7;
+        Graph g0 = random_graph(n0, 2.5 / n0, rng);
+        Graph g1 = random_graph(n1, 2.5 / n1, rng);
+
+        // one bidomain holding every vertex, as built by mcs() for unlabelled graphs
+        vector<Bidomain> domains{{0, 0, n0, n1, false}};
+        vector<int> left(n0), right(n1);
+        std::iota(left.begin(), left.end(), 0);
+        std::iota(right.begin(), right.end(), 0);
+        DoubleQRewards rewards(n0, n1);
+        Stats stats;
+        stats.abort_due_to_timeout = false;
+        // an unreachable upper bound keeps the repair moves going for the whole budget
+        vector<VtxPair> heuristic = warm_start(g0, g1, rewards, domains, left, right, 0.01, n0 + n1, &stats);
+        if (!connected_matching(heuristic, g0, false) || !connected_matching(heuristic, g1, true)) {
+            std::printf("instance %d: disconnected warm start solution of size %zu\n", instance, heuristic.size());
+            failures++;
+            continue;
+        }
+
+        unsigned int exact = solve(g0, g1, 0);
+        unsigned int seeded = solve(g0, g1, 0.01);
+        if (heuristic.size() > exact || seeded != exact) {
+            std::printf("instance %d: warm start %zu, search %u, seeded search %u\n", instance, heuristic.size(),
+                        exact, seeded);
+            failures++;
+        }
+    }
+    std::printf("%s: %d failures\n", failures ? "FAILED" : "passed", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <pthread.h>
+#include <sched.h>
+
+ThreadPool::ThreadPool(int threads, bool pin) : worker_queues(std::max(threads - 1, 0)), pinned(pin) {
+    int cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i + 1 < threads; i++) {
+        workers.emplace_back([this, i] { run(i); });
+        if (pin) {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET((i + 1) % cpus, &cpu_set);
+            pthread_setaffinity_np(workers.back().native_handle(), sizeof(cpu_set), &cpu_set);
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto &worker: workers)
+        worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task, int affinity) {
+    if (workers.empty()) { // nobody else to run it
+        task();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (affinity >= 0)
+            worker_queues[affinity % workers.size()].push_back(std::move(task));
+        else
+            shared_queue.push_back(std::move(task));
+    }
+    // a task bound to a worker must wake that one, so wake them all
+    if (affinity >= 0)
+        cv.notify_all();
+    else
+        cv.notify_one();
+}
+
+void ThreadPool::run(int worker) {
+    std::deque<std::function<void()>> &own_queue = worker_queues[worker];
+    std::unique_lock<std::mutex> guard(mutex);
+    while (true) {
+        cv.wait(guard, [&] { return stopping || !own_queue.empty() || !shared_queue.empty(); });
+        std::deque<std::function<void()>> &queue = !own_queue.empty() ? own_queue : shared_queue;
+        if (queue.empty()) // stopping, and nothing left to run
+            return;
+        std::function<void()> task = std::move(queue.front());
+        queue.pop_front();
+        guard.unlock();
+        task();
+        guard.lock();
+    }
+}
+
+/**
+ * Lanes still to run and lanes done. Queued tasks may outlive run_lanes() (when the caller ran their lanes
+ * itself), so they share its ownership and only touch the body while a lane is left to claim.
+ */
+struct LaneBatch {
+    const std::function<void(int)> *body;
+    int lanes;
+    std::atomic<int> next{0};
+    int done = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    // run lanes until none is left to claim
+    void work() {
+        for (int lane = next++; lane < lanes; lane = next++) {
+            (*body)(lane);
+            std::lock_guard<std::mutex> guard(mutex);
+            if (++done == lanes)
+                cv.notify_all();
+        }
+    }
+};
+
+void ThreadPool::run_lanes(int lanes, const std::function<void(int)> &body) {
+    if (lanes <= 1 || workers.empty()) {
+        for (int lane = 0; lane < lanes; lane++)
+            body(lane);
+        return;
+    }
+    auto batch = std::make_shared<LaneBatch>();
+    batch->body = &body;
+    batch->lanes = lanes;
+    // a lane bound to a busy worker is not lost: the calling thread claims it if the worker has not started it
+    for (int i = 1; i < lanes; i++)
+        submit([batch] { batch->work(); }, pinned ? i - 1 : -1);
+    batch->work();
+    std::unique_lock<std::mutex> guard(batch->mutex);
+    batch->cv.wait(guard, [&] { return batch->done == lanes; });
+}
+
+void ThreadPool::parallel_for(size_t count, size_t grain, int lanes,
+                              const std::function<void(size_t, size_t, int)> &body) {
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+    lanes = (int) std::min<size_t>(std::max(lanes, 1), chunks);
+    if (lanes <= 1) {
+        if (count > 0)
+            body(0, count, 0);
+        return;
+    }
+    std::atomic<size_t> next_chunk(0);
+    run_lanes(lanes, [&](int lane) {
+        for (size_t chunk = next_chunk++; chunk < chunks; chunk = next_chunk++)
+            body(chunk * grain, std::min(count, (chunk + 1) * grain), lane);
+    });
+}
+
+static std::unique_ptr<ThreadPool> pool;
+static std::once_flag pool_created;
+
+void init_thread_pool(int threads, bool pin) {
+    std::call_once(pool_created, [&] { pool = std::make_unique<ThreadPool>(threads, pin); });
+}
+
+ThreadPool &thread_pool() {
+    init_thread_pool(std::max(1u, std::thread::hardware_concurrency()), false);
+    return *pool;
+}
@@ -0,0 +1,65 @@
+#ifndef MCSPLITDAL_THREAD_POOL_H
+#define MCSPLITDAL_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads shared by the whole process: the parallel heuristics, the preprocessing, the batch
+ * modes and the parallel searches all run their work here instead of starting threads of their own.
+ *
+ * The calling thread always takes part in run_lanes() and parallel_for(): it runs every lane no worker has
+ * started yet. Nested parallel sections (a batch worker sorting a graph with a parallel heuristic) therefore
+ * never wait for a free worker; at worst they run sequentially on the thread that asked for them.
+ */
+class ThreadPool {
+public:
+    // threads - 1 workers: with the calling thread, `threads` threads run at once. With pin, worker i is bound
+    // to CPU i + 1 (modulo the number of CPUs), which leaves CPU 0 to the main thread.
+    explicit ThreadPool(int threads, bool pin = false);
+
+    // runs the tasks still queued, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // number of threads that can work at once, the calling thread included
+    int size() const { return (int) workers.size() + 1; }
+
+    // run task on any worker, or with affinity >= 0 always on worker affinity % (size() - 1)
+    void submit(std::function<void()> task, int affinity = -1);
+
+    // run body(lane) for every lane in [0, lanes) and wait for all of them. With pinned workers, lane i > 0 is
+    // submitted to worker i - 1, so that the lanes of a call (batch workers, goals, component pairs) each keep a
+    // CPU of their own instead of going to whichever worker is free.
+    void run_lanes(int lanes, const std::function<void(int)> &body);
+
+    // body(begin, end, lane) on the chunks [k * grain, (k + 1) * grain) of [0, count), handed out one at a time
+    // to at most `lanes` lanes; with a single lane or a single chunk everything runs on the calling thread
+    void parallel_for(size_t count, size_t grain, int lanes,
+                      const std::function<void(size_t, size_t, int)> &body);
+
+private:
+    void run(int worker);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> shared_queue;
+    std::vector<std::deque<std::function<void()>>> worker_queues;
+    bool pinned;
+    bool stopping = false;
+};
+
+// size the process-wide pool; must be called before the first thread_pool(), or it is sized from the hardware
+void init_thread_pool(int threads, bool pin);
+
+ThreadPool &thread_pool();
+
+#endif //MCSPLITDAL_THREAD_POOL_H
@@ -0,0 +1,197 @@
+#include "warm_start.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+// number of w candidates evaluated by look-ahead at each step of a descent
+const int max_lookahead_candidates = 32;
+
+struct DescentState {
+    vector<Bidomain> domains;
+    vector<int> left;
+    vector<int> right;
+    vector<int> g0_matched;
+    vector<int> g1_matched;
+    vector<VtxPair> current;
+};
+
+static int position_in(const vector<int> &arr, int start_idx, int len, int vtx) {
+    for (int i = 0; i < len; i++)
+        if (arr[start_idx + i] == vtx)
+            return i;
+    return -1;
+}
+
+static void undo_assignment(DescentState &s, unsigned int cur_len) {
+    while (s.current.size() > cur_len) {
+        VtxPair pr = s.current.back();
+        s.current.pop_back();
+        s.g0_matched[pr.v] = 0;
+        s.g1_matched[pr.w] = 0;
+    }
+}
+
+/**
+ * Match v (already removed from bidomain bd_idx) with the w at w_idx in the same bidomain, and refine the domains
+ */
+static void assign(DescentState &s, int bd_idx, int v, int w_idx, const Graph &g0, const Graph &g1, Stats *stats) {
+    Bidomain &bd = s.domains[bd_idx];
+    int w = s.right[bd.r + w_idx];
+    remove_vtx_from_array(s.right, bd.r, bd.right_len, w_idx);
+    auto result = generate_new_domains(s.domains, bd_idx, s.current, s.g0_matched, s.g1_matched, s.left, s.right,
+                                       g0, g1, v, w, arguments.directed || arguments.edge_labelled, stats);
+    s.domains = std::move(result.new_domains);
+}
+
+/**
+ * Replay a pair of a previous solution. Returns false if the pair is no longer compatible with the state
+ * (e.g. one of its vertices was already matched as a leaf), in which case it is skipped. In connected mode the
+ * pair must also be adjacent to the pairs already matched, as in select_bidomain().
+ */
+static bool replay(DescentState &s, const VtxPair &pr, const Graph &g0, const Graph &g1, Stats *stats) {
+    if (s.g0_matched[pr.v] || s.g1_matched[pr.w])
+        return false;
+    for (unsigned int i = 0; i < s.domains.size(); i++) {
+        Bidomain &bd = s.domains[i];
+        int v_idx = position_in(s.left, bd.l, bd.left_len, pr.v);
+        if (v_idx == -1)
+            continue;
+        if (arguments.connected && !s.current.empty() && !bd.is_adjacent)
+            return false;
+        int w_idx = position_in(s.right, bd.r, bd.right_len, pr.w);
+        if (w_idx == -1)
+            return false;
+        remove_vtx_from_array(s.left, bd.l, bd.left_len, v_idx);
+        assign(s, i, pr.v, w_idx, g0, g1, stats);
+        return true;
+    }
+    return false;
+}
+
+// whether the matched vertices of g0 induce a connected subgraph (then so do those of g1)
+static bool is_connected_matching(const vector<VtxPair> &matching, const Graph &g0) {
+    if (matching.empty())
+        return true;
+    vector<char> state(g0.n, 0); // 1: matched, 2: matched and reached
+    for (const VtxPair &pr: matching)
+        state[pr.v] = 1;
+    vector<int> queue{matching[0].v};
+    state[matching[0].v] = 2;
+    for (size_t head = 0; head < queue.size(); head++)
+        for (auto &node: g0.adjlist[queue[head]].adjNodes)
+            if (state[node.id] == 1) {
+                state[node.id] = 2;
+                queue.push_back(node.id);
+            }
+    return queue.size() == matching.size();
+}
+
+/**
+ * Extend the current matching until no bidomain is left. The bidomain is chosen as in solve(), v by reward
+ * (or at random when rng is given) and w by one-step look-ahead: the candidate that leaves the largest bound.
+ */
+static void greedy_descent(DescentState &s, const Graph &g0, const Graph &g1, const Rewards &rewards,
+                           std::mt19937 *rng, Stats *stats) {
+    vector<int> candidates;
+    while (!stats->abort_due_to_timeout) {
+        int bd_idx = select_bidomain(s.domains, s.left, rewards, s.current.size());
+        if (bd_idx == -1)
+            break;
+        Bidomain &bd = s.domains[bd_idx];
+        int v_idx = rng ? (int) ((*rng)() % bd.left_len) : selectV_index(s.left, rewards, bd.l, bd.left_len);
+        int v = s.left[bd.l + v_idx];
+        remove_vtx_from_array(s.left, bd.l, bd.left_len, v_idx);
+
+        candidates.assign(s.right.begin() + bd.r, s.right.begin() + bd.r + bd.right_len);
+        if (rng)
+            std::shuffle(candidates.begin(), candidates.end(), *rng);
+        else
+            std::sort(candidates.begin(), candidates.end()); // vertices are numbered by decreasing score
+        if (candidates.size() > max_lookahead_candidates)
+            candidates.resize(max_lookahead_candidates);
+
+        int best_w = -1;
+        int best_score = -1;
+        gtype best_reward = -1;
+        for (int w: candidates) {
+            // try v -> w, measure the bound, then undo (domain contents are only permuted, never lost)
+            int w_idx = position_in(s.right, bd.r, bd.right_len, w);
+            std::swap(s.right[bd.r + w_idx], s.right[bd.r + bd.right_len - 1]);
+            bd.right_len--;
+            unsigned int cur_len = s.current.size();
+            auto result = generate_new_domains(s.domains, bd_idx, s.current, s.g0_matched, s.g1_matched, s.left,
+                                               s.right, g0, g1, v, w, arguments.directed || arguments.edge_labelled,
+                                               stats);
+            int score = s.current.size() + calc_bound(result.new_domains);
+            undo_assignment(s, cur_len);
+            bd.right_len++;
+
+            gtype reward = rewards.get_pair_reward(v, w, false);
+            if (score > best_score || (score == best_score && reward > best_reward)) {
+                best_w = w;
+                best_score = score;
+                best_reward = reward;
+            }
+        }
+        assign(s, bd_idx, v, position_in(s.right, bd.r, bd.right_len, best_w), g0, g1, stats);
+    }
+}
+
+vector<VtxPair> warm_start(const Graph &g0, const Graph &g1, const Rewards &rewards,
+                           const vector<Bidomain> &domains, const vector<int> &left, const vector<int> &right,
+                           double time_budget, unsigned int upper_bound, Stats *stats) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(time_budget);
+
+    DescentState initial;
+    initial.domains = domains;
+    initial.left = left;
+    initial.right = right;
+    initial.g0_matched = vector<int>(g0.n, 0);
+    initial.g1_matched = vector<int>(g1.n, 0);
+
+    DescentState s = initial;
+    greedy_descent(s, g0, g1, rewards, nullptr, stats);
+    vector<VtxPair> best = s.current;
+
+    // destroy and repair: drop a few pairs (up to a third of the solution), extend again at random,
+    // keep the result if not worse
+    std::mt19937 rng(best.size());
+    unsigned long long iterations = 0;
+    while (best.size() < upper_bound && !stats->abort_due_to_timeout &&
+           std::chrono::steady_clock::now() < deadline) {
+        vector<VtxPair> kept = best;
+        int drop = 1 + rng() % std::max<size_t>(2, best.size() / 3);
+        for (int i = 0; i < drop && !kept.empty(); i++)
+            kept.erase(kept.begin() + rng() % kept.size());
+
+        s = initial;
+        // in connected mode a kept pair may only become adjacent once a later one is matched: sweep until no
+        // pair can be added
+        for (bool progress = true; progress;) {
+            progress = false;
+            for (unsigned int i = 0; i < kept.size();) {
+                if (replay(s, kept[i], g0, g1, stats)) {
+                    progress = true;
+                    kept.erase(kept.begin() + i);
+                } else if (s.g0_matched[kept[i].v] || s.g1_matched[kept[i].w]) {
+                    kept.erase(kept.begin() + i); // taken by a leaf match
+                } else {
+                    i++;
+                }
+            }
+            if (!arguments.connected)
+                break;
+        }
+        greedy_descent(s, g0, g1, rewards, &rng, stats);
+        // drops can cut the solution in two, which only matters in connected mode
+        if (s.current.size() >= best.size() && (!arguments.connected || is_connected_matching(s.current, g0)))
+            best = s.current;
+        iterations++;
+    }
+
+    if (!arguments.quiet)
+        cout << "Warm start: incumbent size " << best.size() << " after " << iterations << " local search moves"
+             << endl;
+    return best;
+}
@@ -0,0 +1,21 @@
+#ifndef MCSPLITDAL_WARM_START_H
+#define MCSPLITDAL_WARM_START_H
+
+#include <vector>
+#include "graph.h"
+#include "mcs.h"
+#include "reward.h"
+
+/**
+ * Constructive + local search heuristic run before the exact search, to start it with a real incumbent.
+ * A greedy descent (bidomain and v as in solve(), w chosen by one-step look-ahead on the bound) builds a
+ * first solution, then destroy-and-repair moves drop a few pairs of the best solution and extend
+ * the rest again with randomised greedy descents, until time_budget seconds have passed, the
+ * timeout fires or the solution reaches upper_bound.
+ * domains, left and right are the initial bidomains of mcs(); they are not modified.
+ */
+vector<VtxPair> warm_start(const Graph &g0, const Graph &g1, const Rewards &rewards,
+                           const vector<Bidomain> &domains, const vector<int> &left, const vector<int> &right,
+                           double time_budget, unsigned int upper_bound, Stats *stats);
+
+#endif //MCSPLITDAL_WARM_START_H